@@ -0,0 +1,209 @@
+#include "AudioTelemetry.h"
+
+//==============================================================================
+TelemetryChannel::TelemetryChannel()
+    : leftSamples ((size_t) sampleCapacity), rightSamples ((size_t) sampleCapacity)
+{
+}
+
+template <typename SampleType>
+void TelemetryChannel::push (const juce::AudioBuffer<SampleType>& buffer, const VoicePool::Status& status) noexcept
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto* left = buffer.getReadPointer (0);
+    const auto* right = buffer.getReadPointer (buffer.getNumChannels() > 1 ? 1 : 0);
+
+    {
+        const auto scope = sampleFifo.write (numSamples);
+        const auto written = scope.blockSize1 + scope.blockSize2;
+
+        if (written < numSamples)
+            droppedSamples.fetch_add ((juce::uint32) (numSamples - written), std::memory_order_relaxed);
+
+        if (scope.blockSize1 > 0)
+        {
+            std::copy (left, left + scope.blockSize1, leftSamples.begin() + scope.startIndex1);
+            std::copy (right, right + scope.blockSize1, rightSamples.begin() + scope.startIndex1);
+        }
+
+        if (scope.blockSize2 > 0)
+        {
+            std::copy (left + scope.blockSize1, left + written, leftSamples.begin() + scope.startIndex2);
+            std::copy (right + scope.blockSize1, right + written, rightSamples.begin() + scope.startIndex2);
+        }
+    }
+
+    const auto scope = statusFifo.write (1);
+
+    if (scope.blockSize1 > 0)
+        statuses[(size_t) scope.startIndex1] = status;
+}
+
+template void TelemetryChannel::push (const juce::AudioBuffer<float>&, const VoicePool::Status&) noexcept;
+template void TelemetryChannel::push (const juce::AudioBuffer<double>&, const VoicePool::Status&) noexcept;
+
+void TelemetryChannel::setEnabled (bool shouldBeEnabled) noexcept
+{
+    if (shouldBeEnabled)
+    {
+        // Reading is ours, so stale data can be skipped even while the audio
+        // thread is still writing
+        sampleFifo.finishedRead (sampleFifo.getNumReady());
+        statusFifo.finishedRead (statusFifo.getNumReady());
+    }
+
+    enabled.store (shouldBeEnabled);
+}
+
+int TelemetryChannel::pull (float* left, float* right, int maxSamples) noexcept
+{
+    const auto scope = sampleFifo.read (juce::jmin (maxSamples, sampleFifo.getNumReady()));
+
+    if (scope.blockSize1 > 0)
+    {
+        std::copy_n (leftSamples.begin() + scope.startIndex1, scope.blockSize1, left);
+        std::copy_n (rightSamples.begin() + scope.startIndex1, scope.blockSize1, right);
+    }
+
+    if (scope.blockSize2 > 0)
+    {
+        std::copy_n (leftSamples.begin() + scope.startIndex2, scope.blockSize2, left + scope.blockSize1);
+        std::copy_n (rightSamples.begin() + scope.startIndex2, scope.blockSize2, right + scope.blockSize1);
+    }
+
+    return scope.blockSize1 + scope.blockSize2;
+}
+
+bool TelemetryChannel::pullStatus (VoicePool::Status& status) noexcept
+{
+    const auto numReady = statusFifo.getNumReady();
+
+    if (numReady == 0)
+        return false;
+
+    // Only the latest one matters
+    const auto scope = statusFifo.read (numReady);
+    status = statuses[(size_t) (scope.blockSize2 > 0 ? scope.startIndex2 + scope.blockSize2 - 1
+                                                     : scope.startIndex1 + scope.blockSize1 - 1)];
+    return true;
+}
+
+//==============================================================================
+TelemetryAnalyser::TelemetryAnalyser (TelemetryChannel& c, int framesPerSecond)
+    : juce::Thread ("Telemetry Analyser"),
+      channel (c),
+      frameIntervalMs (1000 / juce::jmax (1, framesPerSecond)),
+      historyLeft ((size_t) fftSize), historyRight ((size_t) fftSize),
+      pulledLeft ((size_t) fftSize), pulledRight ((size_t) fftSize),
+      fftData ((size_t) fftSize * 2)
+{
+    channel.setEnabled (true);
+    startThread (juce::Thread::Priority::low);
+}
+
+TelemetryAnalyser::~TelemetryAnalyser()
+{
+    channel.setEnabled (false);
+    stopThread (1000);
+}
+
+bool TelemetryAnalyser::getLatestFrame (Frame& frame) const
+{
+    const juce::SpinLock::ScopedLockType lock (publishLock);
+
+    if (published.number == frame.number)
+        return false;
+
+    frame = published;
+    return true;
+}
+
+void TelemetryAnalyser::run()
+{
+    while (! threadShouldExit())
+    {
+        if (drain())
+            analyse();
+
+        wait (frameIntervalMs);
+    }
+}
+
+bool TelemetryAnalyser::drain()
+{
+    bool gotAudio = false;
+
+    for (;;)
+    {
+        const auto numPulled = channel.pull (pulledLeft.data(), pulledRight.data(), fftSize);
+
+        if (numPulled == 0)
+            break;
+
+        gotAudio = true;
+
+        for (int i = 0; i < numPulled; ++i)
+        {
+            peakSinceFrame[0] = juce::jmax (peakSinceFrame[0], std::abs (pulledLeft[(size_t) i]));
+            peakSinceFrame[1] = juce::jmax (peakSinceFrame[1], std::abs (pulledRight[(size_t) i]));
+
+            historyLeft[(size_t) historyPosition] = pulledLeft[(size_t) i];
+            historyRight[(size_t) historyPosition] = pulledRight[(size_t) i];
+            historyPosition = (historyPosition + 1) % fftSize;
+        }
+    }
+
+    channel.pullStatus (working.voices);
+    return gotAudio;
+}
+
+void TelemetryAnalyser::analyse()
+{
+    // Unroll the history, oldest first, as a mono mix
+    auto* mono = fftData.data();
+    double sumLeft = 0.0, sumRight = 0.0;
+
+    for (int i = 0; i < fftSize; ++i)
+    {
+        const auto index = (size_t) ((historyPosition + i) % fftSize);
+        const auto left = historyLeft[index], right = historyRight[index];
+
+        mono[i] = 0.5f * (left + right);
+        sumLeft += left * left;
+        sumRight += right * right;
+    }
+
+    working.rms[0] = (float) std::sqrt (sumLeft / fftSize);
+    working.rms[1] = (float) std::sqrt (sumRight / fftSize);
+    working.peak[0] = std::exchange (peakSinceFrame[0], 0.0f);
+    working.peak[1] = std::exchange (peakSinceFrame[1], 0.0f);
+
+    // Trigger the scope on the latest rising zero crossing that still leaves a
+    // full trace behind it, so periodic signals stand still
+    auto start = fftSize - scopeSize;
+
+    for (int i = fftSize - scopeSize; i > 0; --i)
+    {
+        if (mono[i - 1] < 0.0f && mono[i] >= 0.0f)
+        {
+            start = i;
+            break;
+        }
+    }
+
+    std::copy_n (mono + start, scopeSize, working.scope.begin());
+
+    window.multiplyWithWindowingTable (mono, (size_t) fftSize);
+    std::fill (mono + fftSize, mono + 2 * fftSize, 0.0f);
+    fft.performFrequencyOnlyForwardTransform (mono, true);
+
+    // The Hann window halves the amplitude, a full scale sine peaks at fftSize / 4
+    for (int bin = 0; bin < numBins; ++bin)
+        working.spectrum[(size_t) bin] = juce::Decibels::gainToDecibels (mono[bin] * (4.0f / fftSize), -120.0f);
+
+    working.sampleRate = channel.getSampleRate();
+    ++working.number;
+
+    const juce::SpinLock::ScopedLockType lock (publishLock);
+    published = working;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "SynthVoice.h"
+
+//==============================================================================
+/** Carries the processor's output and voice status from the audio thread to
+    whoever is displaying them.
+
+    Single producer, single consumer, fixed size and lock-free. Nothing is
+    pushed unless a consumer has enabled the channel, so with the editor closed
+    the audio thread pays one atomic load per block. When the consumer falls
+    behind, samples that don't fit are dropped rather than waited for.
+*/
+class TelemetryChannel
+{
+public:
+    TelemetryChannel();
+
+    void prepare (double sampleRate) noexcept         { currentSampleRate.store (sampleRate); }
+    double getSampleRate() const noexcept               { return currentSampleRate.load(); }
+
+    //==============================================================================
+    /** Audio thread. Double precision output is narrowed to float on the way. */
+    bool isEnabled() const noexcept                     { return enabled.load (std::memory_order_relaxed); }
+
+    template <typename SampleType>
+    void push (const juce::AudioBuffer<SampleType>& buffer, const VoicePool::Status& status) noexcept;
+
+    //==============================================================================
+    /** Consumer thread. Enabling throws away whatever was left from before. */
+    void setEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Reads up to maxSamples of each channel, returns how many were read. */
+    int pull (float* left, float* right, int maxSamples) noexcept;
+
+    /** Gets the status of the most recent block, if any arrived since the last
+        call.
+    */
+    bool pullStatus (VoicePool::Status& status) noexcept;
+
+    juce::uint32 getNumDroppedSamples() const noexcept  { return droppedSamples.load (std::memory_order_relaxed); }
+
+private:
+    static constexpr int sampleCapacity = 1 << 15;
+    static constexpr int statusCapacity = 256;
+
+    juce::AbstractFifo sampleFifo { sampleCapacity };
+    std::vector<float> leftSamples, rightSamples;
+
+    juce::AbstractFifo statusFifo { statusCapacity };
+    std::array<VoicePool::Status, statusCapacity> statuses;
+
+    std::atomic<bool> enabled { false };
+    std::atomic<double> currentSampleRate { 44100.0 };
+    std::atomic<juce::uint32> droppedSamples { 0 };
+};
+
+//==============================================================================
+/** Drains a TelemetryChannel on its own thread and turns it into frames for
+    display: a scope trace, a spectrum and peak/RMS levels.
+
+    Frames are only produced while audio keeps arriving, at most framesPerSecond
+    times a second. The channel is enabled for as long as the analyser exists.
+*/
+class TelemetryAnalyser final : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2;
+    static constexpr int scopeSize = 512;
+
+    struct Frame
+    {
+        std::array<float, scopeSize> scope {};      // mono, starting at a rising zero crossing where there is one
+        std::array<float, numBins> spectrum {};     // dB, 0 for a full scale sine
+        float peak[2] {};                           // since the previous frame
+        float rms[2] {};                            // over the last fftSize samples
+        VoicePool::Status voices;
+        double sampleRate = 44100.0;
+        juce::uint32 number = 0;
+    };
+
+    explicit TelemetryAnalyser (TelemetryChannel& channel, int framesPerSecond = 30);
+    ~TelemetryAnalyser() override;
+
+    /** Copies the newest frame into frame unless it has already got it. Safe
+        to call from the message thread.
+    */
+    bool getLatestFrame (Frame& frame) const;
+
+private:
+    void run() override;
+    bool drain();
+    void analyse();
+
+    TelemetryChannel& channel;
+    const int frameIntervalMs;
+
+    // The last fftSize samples, oldest at historyPosition
+    std::vector<float> historyLeft, historyRight;
+    int historyPosition = 0;
+
+    std::vector<float> pulledLeft, pulledRight;
+    float peakSinceFrame[2] {};
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann };
+    std::vector<float> fftData;
+
+    Frame working, published;
+    juce::SpinLock publishLock;
+};
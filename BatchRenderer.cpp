@@ -0,0 +1,99 @@
+#include "BatchRenderer.h"
+
+#include <thread>
+
+//==============================================================================
+double BatchRenderer::Report::getAudioSeconds() const
+{
+    double total = 0.0;
+
+    for (auto& job : jobs)
+        total += job.result.audioSeconds;
+
+    return total;
+}
+
+double BatchRenderer::Report::getThroughput() const
+{
+    return wallSeconds > 0.0 ? getAudioSeconds() / wallSeconds : 0.0;
+}
+
+//==============================================================================
+BatchRenderer::BatchRenderer (int numWorkers)
+{
+    // Processors are created up front on the calling thread, and live as long
+    // as the batch renderer so consecutive batches reuse them
+    for (int i = 0; i < juce::jmax (1, numWorkers); ++i)
+    {
+        renderers.push_back (std::make_unique<OfflineRenderer>());
+        queues.push_back (std::make_unique<WorkQueue>());
+    }
+}
+
+BatchRenderer::Report BatchRenderer::render (const std::vector<RenderJob>& jobs)
+{
+    Report report;
+    report.jobs.resize (jobs.size());
+
+    for (size_t i = 0; i < jobs.size(); ++i)
+        queues[i % queues.size()]->jobs.push_back (i);
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    std::vector<std::thread> threads;
+
+    for (int worker = 1; worker < getNumWorkers(); ++worker)
+        threads.emplace_back ([this, worker, &jobs, &report] { runWorker (worker, jobs, report); });
+
+    runWorker (0, jobs, report);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    report.wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    return report;
+}
+
+bool BatchRenderer::getNextJob (int worker, size_t& job)
+{
+    {
+        auto& own = *queues[(size_t) worker];
+        const std::lock_guard<std::mutex> sl (own.lock);
+
+        if (! own.jobs.empty())
+        {
+            job = own.jobs.front();
+            own.jobs.pop_front();
+            return true;
+        }
+    }
+
+    // Nothing is queued once a batch has started, so after one fruitless pass
+    // over the other queues there is no work left for this worker
+    for (int offset = 1; offset < getNumWorkers(); ++offset)
+    {
+        auto& victim = *queues[(size_t) ((worker + offset) % getNumWorkers())];
+        const std::lock_guard<std::mutex> sl (victim.lock);
+
+        if (! victim.jobs.empty())
+        {
+            job = victim.jobs.back();
+            victim.jobs.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void BatchRenderer::runWorker (int worker, const std::vector<RenderJob>& jobs, Report& report)
+{
+    auto& renderer = *renderers[(size_t) worker];
+
+    // Each job writes only its own report slot, so no locking is needed here
+    for (size_t job = 0; getNextJob (worker, job);)
+    {
+        report.jobs[job].result = renderer.render (jobs[job]);
+        report.jobs[job].worker = worker;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "OfflineRenderer.h"
+
+#include <deque>
+#include <mutex>
+
+//==============================================================================
+/** Renders many independent jobs concurrently.
+
+    Each worker thread owns an OfflineRenderer, i.e. its own processor and
+    buffers. Jobs are dealt out round-robin into per-worker queues; a worker
+    takes from the front of its own queue and, once that runs dry, steals from
+    the back of the others, so long jobs don't leave cores idle at the end.
+*/
+class BatchRenderer
+{
+public:
+    explicit BatchRenderer (int numWorkers);
+
+    struct JobReport
+    {
+        RenderResult result;
+        int worker = -1;
+    };
+
+    struct Report
+    {
+        std::vector<JobReport> jobs;
+        double wallSeconds = 0.0;
+
+        double getAudioSeconds() const;
+
+        /** Seconds of audio rendered per wall clock second, across all workers. */
+        double getThroughput() const;
+    };
+
+    Report render (const std::vector<RenderJob>& jobs);
+
+    int getNumWorkers() const       { return static_cast<int> (renderers.size()); }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex lock;
+        std::deque<size_t> jobs;
+    };
+
+    bool getNextJob (int worker, size_t& job);
+    void runWorker (int worker, const std::vector<RenderJob>& jobs, Report& report);
+
+    std::vector<std::unique_ptr<OfflineRenderer>> renderers;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BatchRenderer)
+};
@@ -0,0 +1,871 @@
+#include "PluginEditor.h"
+#include "PluginProcessor.h"
+
+#include <iostream>
+
+//==============================================================================
+/** Micro-benchmarks for processBlock and the voice kernel.
+
+    Every case renders a fixed amount of audio a few times over and keeps the
+    fastest run, reported as nanoseconds per output sample. Results go out as
+    JSON or CSV so runs can be diffed and gated on.
+*/
+namespace
+{
+    constexpr double benchmarkSampleRate = 48000.0;
+
+    const juce::StringArray waveNames { "Sine", "Saw", "Square", "Triangle", "User" };
+    const juce::StringArray filterNames { "Lowpass", "Bandpass", "Highpass" };
+
+    struct Settings
+    {
+        juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        juce::Array<int> voiceCounts { 1, 4, 8, 16 };
+        juce::Array<int> threadCounts { 0, 1, 2, 3 };
+        double seconds = 0.2;
+        int repeats = 3;
+        bool runProcessBlock = true;
+        bool runKernels = true;
+        bool runThreads = true;
+        bool runPrecision = true;
+        bool runDispatch = true;
+        bool runEditor = true;
+    };
+
+    struct Measurement
+    {
+        juce::String suite, name, implementation, precision { "float" };
+        int blockSize = 0, voices = 0, threads = 0, unison = 1;
+        juce::String osc1, osc2, filter;
+        bool lfo = false;
+        double nsPerSample = 0.0;
+        double maxDeviation = 0.0;  // from the float output, for the double precision cases
+        double speedup = 0.0;       // of the specialised kernel over the generic one, for the dispatch cases
+        double milliseconds = 0.0;  // for the cases timed once per call rather than per sample
+    };
+
+    /** Calls render (numSamples) until the total reaches the requested length,
+        repeated a few times, and returns the best time in ns per sample.
+    */
+    template <typename RenderFunction>
+    double timeBest (const Settings& settings, int numSamplesPerCall, RenderFunction&& render)
+    {
+        const auto numCalls = juce::jmax (1, static_cast<int> (settings.seconds * benchmarkSampleRate) / numSamplesPerCall);
+        auto best = std::numeric_limits<double>::max();
+
+        // One untimed pass first, to warm up caches and settle any smoothing
+        for (int i = 0; i < numCalls; ++i)
+            render (numSamplesPerCall);
+
+        for (int repeat = 0; repeat < settings.repeats; ++repeat)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numCalls; ++i)
+                render (numSamplesPerCall);
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+            best = juce::jmin (best, seconds * 1.0e9 / (numCalls * numSamplesPerCall));
+        }
+
+        return best;
+    }
+
+    //==============================================================================
+    void setParameter (AudioPluginAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter (id);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    void benchmarkProcessBlock (const Settings& settings, std::vector<Measurement>& results)
+    {
+        AudioPluginAudioProcessor processor;
+        juce::AudioBuffer<float> buffer (2, settings.blockSizes.isEmpty() ? 0 : *std::max_element (settings.blockSizes.begin(), settings.blockSizes.end()));
+        juce::MidiBuffer midi, noMidi;
+
+        setParameter (processor, AudioPluginAudioProcessor::MASTER_ALWAYS_ON, 0.0f);
+
+        for (auto blockSize : settings.blockSizes)
+        {
+            for (int osc1 = 0; osc1 < waveNames.size(); ++osc1)
+              for (int osc2 = 0; osc2 < waveNames.size(); ++osc2)
+                for (int filter = 0; filter < filterNames.size(); ++filter)
+                  for (auto lfo : { false, true })
+                    for (auto voices : settings.voiceCounts)
+                    {
+                        setParameter (processor, AudioPluginAudioProcessor::OSC1_WAVE, (float) osc1);
+                        setParameter (processor, AudioPluginAudioProcessor::OSC2_WAVE, (float) osc2);
+                        setParameter (processor, AudioPluginAudioProcessor::FILTER_TYPE, (float) filter);
+                        setParameter (processor, AudioPluginAudioProcessor::LFO_DEPTH, lfo ? 0.5f : 0.0f);
+                        setParameter (processor, AudioPluginAudioProcessor::LFO_RATE, 5.0f);
+
+                        processor.setRateAndBufferSizeDetails (benchmarkSampleRate, blockSize);
+                        processor.prepareToPlay (benchmarkSampleRate, blockSize);
+
+                        // Held chord, spread over a few octaves
+                        midi.clear();
+
+                        for (int i = 0; i < voices; ++i)
+                            midi.addEvent (juce::MidiMessage::noteOn (1, 36 + i * 5, 0.8f), 0);
+
+                        juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), 2, blockSize);
+                        processor.processBlock (block, midi);
+
+                        Measurement m;
+                        m.suite = "processBlock";
+                        m.name = "processBlock";
+                        m.blockSize = blockSize;
+                        m.voices = voices;
+                        m.osc1 = waveNames[osc1];
+                        m.osc2 = waveNames[osc2];
+                        m.filter = filterNames[filter];
+                        m.lfo = lfo;
+                        m.nsPerSample = timeBest (settings, blockSize, [&] (int) { processor.processBlock (block, noMidi); });
+                        results.push_back (m);
+
+                        processor.releaseResources();
+                    }
+
+            std::cerr << "." << std::flush;
+        }
+    }
+
+    //==============================================================================
+    /** processBlock with the voices spread over 0 to n worker threads, to show
+        from which voice counts and block sizes the workers pay for the hand-off.
+    */
+    void benchmarkThreads (const Settings& settings, std::vector<Measurement>& results)
+    {
+        AudioPluginAudioProcessor processor;
+        juce::AudioBuffer<float> buffer (2, settings.blockSizes.isEmpty() ? 0 : *std::max_element (settings.blockSizes.begin(), settings.blockSizes.end()));
+        juce::MidiBuffer midi, noMidi;
+
+        setParameter (processor, AudioPluginAudioProcessor::MASTER_ALWAYS_ON, 0.0f);
+        setParameter (processor, AudioPluginAudioProcessor::OSC1_WAVE, 1.0f);
+        setParameter (processor, AudioPluginAudioProcessor::OSC2_WAVE, 1.0f);
+
+        for (auto threads : settings.threadCounts)
+        {
+            processor.setNumVoiceThreads (threads);
+
+            for (auto blockSize : settings.blockSizes)
+                for (auto voices : settings.voiceCounts)
+                {
+                    processor.setRateAndBufferSizeDetails (benchmarkSampleRate, blockSize);
+                    processor.prepareToPlay (benchmarkSampleRate, blockSize);
+
+                    midi.clear();
+
+                    for (int i = 0; i < voices; ++i)
+                        midi.addEvent (juce::MidiMessage::noteOn (1, 36 + i * 5, 0.8f), 0);
+
+                    juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), 2, blockSize);
+                    processor.processBlock (block, midi);
+
+                    Measurement m;
+                    m.suite = "threads";
+                    m.name = "processBlock";
+                    m.blockSize = blockSize;
+                    m.voices = voices;
+                    m.threads = threads;
+                    m.osc1 = waveNames[1];
+                    m.osc2 = waveNames[1];
+                    m.filter = filterNames[0];
+                    m.nsPerSample = timeBest (settings, blockSize, [&] (int) { processor.processBlock (block, noMidi); });
+                    results.push_back (m);
+
+                    processor.releaseResources();
+                }
+
+            std::cerr << "." << std::flush;
+        }
+    }
+
+    //==============================================================================
+    /** processBlock through the float and the double precision entry points,
+        with the same patch and chord. The voices render in float either way,
+        so the double output should be the float output widened, sample for
+        sample; the largest difference is reported alongside the timings.
+    */
+    void benchmarkPrecision (const Settings& settings, std::vector<Measurement>& results)
+    {
+        const auto maxBlockSize = settings.blockSizes.isEmpty() ? 0 : *std::max_element (settings.blockSizes.begin(), settings.blockSizes.end());
+        juce::AudioBuffer<float> floatBuffer (2, maxBlockSize);
+        juce::AudioBuffer<double> doubleBuffer (2, maxBlockSize);
+        juce::MidiBuffer midi, noMidi;
+
+        for (auto blockSize : settings.blockSizes)
+        {
+            for (auto voices : settings.voiceCounts)
+            {
+                // Fresh processors, so both start from the same LFO phase and voices
+                AudioPluginAudioProcessor floatProcessor, doubleProcessor;
+
+                for (auto [processor, precision] : { std::pair { &floatProcessor, juce::AudioProcessor::singlePrecision },
+                                                     std::pair { &doubleProcessor, juce::AudioProcessor::doublePrecision } })
+                {
+                    setParameter (*processor, AudioPluginAudioProcessor::MASTER_ALWAYS_ON, 0.0f);
+                    setParameter (*processor, AudioPluginAudioProcessor::OSC1_WAVE, 1.0f);
+                    setParameter (*processor, AudioPluginAudioProcessor::OSC2_WAVE, 2.0f);
+                    setParameter (*processor, AudioPluginAudioProcessor::LFO_DEPTH, 0.5f);
+                    setParameter (*processor, AudioPluginAudioProcessor::LFO_RATE, 5.0f);
+
+                    processor->setProcessingPrecision (precision);
+                    processor->setRateAndBufferSizeDetails (benchmarkSampleRate, blockSize);
+                    processor->prepareToPlay (benchmarkSampleRate, blockSize);
+                }
+
+                midi.clear();
+
+                for (int i = 0; i < voices; ++i)
+                    midi.addEvent (juce::MidiMessage::noteOn (1, 36 + i * 5, 0.8f), 0);
+
+                juce::AudioBuffer<float> floatBlock (floatBuffer.getArrayOfWritePointers(), 2, blockSize);
+                juce::AudioBuffer<double> doubleBlock (doubleBuffer.getArrayOfWritePointers(), 2, blockSize);
+
+                // Both run in lockstep for a while, comparing every sample
+                const auto numCompared = juce::jmax (1, static_cast<int> (settings.seconds * benchmarkSampleRate) / blockSize);
+                double maxDeviation = 0.0;
+
+                for (int block = 0; block < numCompared; ++block)
+                {
+                    floatProcessor.processBlock (floatBlock, block == 0 ? midi : noMidi);
+                    doubleProcessor.processBlock (doubleBlock, block == 0 ? midi : noMidi);
+
+                    for (int channel = 0; channel < 2; ++channel)
+                        for (int i = 0; i < blockSize; ++i)
+                            maxDeviation = juce::jmax (maxDeviation, std::abs ((double) floatBlock.getSample (channel, i) - doubleBlock.getSample (channel, i)));
+                }
+
+                Measurement m;
+                m.suite = "precision";
+                m.name = "processBlock";
+                m.blockSize = blockSize;
+                m.voices = voices;
+                m.osc1 = waveNames[1];
+                m.osc2 = waveNames[2];
+                m.filter = filterNames[0];
+                m.lfo = true;
+
+                m.nsPerSample = timeBest (settings, blockSize, [&] (int) { floatProcessor.processBlock (floatBlock, noMidi); });
+                results.push_back (m);
+
+                m.precision = "double";
+                m.maxDeviation = maxDeviation;
+                m.nsPerSample = timeBest (settings, blockSize, [&] (int) { doubleProcessor.processBlock (doubleBlock, noMidi); });
+                results.push_back (m);
+
+                floatProcessor.releaseResources();
+                doubleProcessor.releaseResources();
+            }
+
+            std::cerr << "." << std::flush;
+        }
+    }
+
+    //==============================================================================
+    /** Spreads the lanes over five octaves, with a long attack so the envelope
+        moves through every timed run, and alternates their pan. Every lane gets
+        the same filter on both sides.
+    */
+    void initialiseLanes (VoiceLanes& lanes, const WavetableBank& wavetables, int osc1, int osc2, const FilterCoefficients& filter)
+    {
+        lanes = {};
+
+        for (int i = 0; i < VoiceLanes::numLanes; ++i)
+        {
+            lanes.osc1Increment[i] = static_cast<float> ((55.0 + 40.0 * i) / benchmarkSampleRate);
+            lanes.osc2Increment[i] = lanes.osc1Increment[i] * 1.01f;
+            lanes.osc1Table[i] = wavetables.getTable (osc1, lanes.osc1Increment[i]);
+            lanes.osc2Table[i] = wavetables.getTable (osc2, lanes.osc2Increment[i]);
+            lanes.osc1Gain[i] = 0.075f;
+            lanes.osc2Gain[i] = 0.075f;
+
+            for (int side = 0; side < 2; ++side)
+                lanes.setFilter (side, i, filter, {});
+
+            lanes.envelopeRate[i] = 1.0e-7f;
+            lanes.envelopeTarget[i] = 1.0f;
+
+            lanes.panLeft[i] = (i & 1) != 0 ? 0.5f : 1.0f;
+            lanes.panRight[i] = (i & 1) != 0 ? 1.0f : 0.5f;
+        }
+    }
+
+    void benchmarkKernels (const Settings& settings, std::vector<Measurement>& results)
+    {
+        constexpr int numSamples = 256;
+
+        WavetableBank wavetables;
+        wavetables.prepare (benchmarkSampleRate);
+
+        FilterControl filterControl;
+        filterControl.prepare (benchmarkSampleRate, FilterControl::defaultControlInterval);
+        filterControl.reset (1000.0f, 0.7f);
+
+        std::vector<float> output (numSamples);
+        VoiceLanes lanes;
+
+        FilterCoefficients increment;
+        const auto coefficients = filterControl.getNextControlStep (increment);
+
+        auto resetLanes = [&] (int osc1, int osc2)
+        {
+            initialiseLanes (lanes, wavetables, osc1, osc2, coefficients);
+        };
+
+        VoiceKernelParameters params;
+
+        const auto allGroups = (1u << (VoiceLanes::numLanes / VoiceKernel::getLanesPerGroup())) - 1;
+
+        auto add = [&] (const juce::String& name, VoiceKernel::Implementation implementation, VoiceKernel::Stage stage,
+                        int osc1, int osc2, int filter)
+        {
+            resetLanes (osc1, osc2);
+            params.osc1WaveType = osc1;
+            params.osc2WaveType = osc2;
+            params.filterType = filter;
+
+            Measurement m;
+            m.suite = "kernel";
+            m.name = name;
+            m.implementation = implementation == VoiceKernel::Implementation::simd ? "simd" : "scalar";
+            m.blockSize = numSamples;
+            m.voices = VoiceLanes::numLanes;
+            m.osc1 = waveNames[osc1];
+            m.osc2 = waveNames[osc2];
+            m.filter = filterNames[filter];
+            m.nsPerSample = timeBest (settings, numSamples, [&] (int n)
+            {
+                std::fill (output.begin(), output.end(), 0.0f);
+                VoiceKernel::renderStage (implementation, stage, lanes, params, allGroups, output.data(), n);
+            });
+
+            results.push_back (m);
+        };
+
+        for (auto implementation : { VoiceKernel::Implementation::scalar, VoiceKernel::getBestImplementation() })
+        {
+            for (int wave = 0; wave < waveNames.size(); ++wave)
+                add ("oscillators", implementation, VoiceKernel::Stage::oscillators, wave, wave, 0);
+
+            // Of the oscillators, only the sine depends on the accuracy tier
+            params.accuracy = FastMath::Accuracy::draft;
+            add ("oscillators draft", implementation, VoiceKernel::Stage::oscillators, WavetableBank::sine, WavetableBank::sine, 0);
+            params.accuracy = FastMath::Accuracy::exact;
+
+            for (int filter = 0; filter < filterNames.size(); ++filter)
+                add ("filter", implementation, VoiceKernel::Stage::filter, 0, 0, filter);
+
+            add ("envelope", implementation, VoiceKernel::Stage::envelope, 0, 0, 0);
+
+            for (int filter = 0; filter < filterNames.size(); ++filter)
+                add ("voice", implementation, VoiceKernel::Stage::complete, 1, 1, filter);
+
+            if (VoiceKernel::getBestImplementation() == VoiceKernel::Implementation::scalar)
+                break;
+        }
+
+        // Complete stereo voices with growing unison stacks, i.e. a 16 note
+        // supersaw chord at the top end
+        std::vector<float> outputRight (numSamples);
+
+        for (auto copies : { 1, 2, 4, 8, 16 })
+        {
+            resetLanes (1, 1);
+
+            auto unison = params;
+            unison.osc1WaveType = WavetableBank::saw;
+            unison.osc2WaveType = WavetableBank::saw;
+            unison.filterType = 0;
+            unison.unisonVoices = copies;
+            unison.secondFilter = true;
+
+            for (int copy = 0; copy < copies; ++copy)
+            {
+                unison.unisonRatio[copy] = 1.0f + 0.002f * (float) copy;
+                unison.unisonLeft[copy] = (copy & 1) != 0 ? 0.1f : 0.2f;
+                unison.unisonRight[copy] = (copy & 1) != 0 ? 0.2f : 0.1f;
+            }
+
+            const auto implementation = VoiceKernel::getBestImplementation();
+
+            Measurement m;
+            m.suite = "kernel";
+            m.name = "unison";
+            m.implementation = implementation == VoiceKernel::Implementation::simd ? "simd" : "scalar";
+            m.blockSize = numSamples;
+            m.voices = VoiceLanes::numLanes;
+            m.unison = copies;
+            m.osc1 = waveNames[1];
+            m.osc2 = waveNames[1];
+            m.filter = filterNames[0];
+            m.nsPerSample = timeBest (settings, numSamples, [&] (int n)
+            {
+                std::fill (output.begin(), output.end(), 0.0f);
+                std::fill (outputRight.begin(), outputRight.end(), 0.0f);
+                VoiceKernel::render (implementation, lanes, unison, allGroups, output.data(), outputRight.data(), n);
+            });
+
+            results.push_back (m);
+        }
+
+        // The ways a complete voice can reach the outputs: left only, panned
+        // after one filter, or through a filter per side
+        for (auto [name, stereo, secondFilter] : { std::tuple { "mono", false, false },
+                                                   std::tuple { "panned", true, false },
+                                                   std::tuple { "dual filter", true, true } })
+        {
+            resetLanes (1, 1);
+
+            auto voice = params;
+            voice.osc1WaveType = WavetableBank::saw;
+            voice.osc2WaveType = WavetableBank::saw;
+            voice.filterType = 0;
+            voice.secondFilter = secondFilter;
+
+            const auto implementation = VoiceKernel::getBestImplementation();
+
+            Measurement m;
+            m.suite = "kernel";
+            m.name = name;
+            m.implementation = implementation == VoiceKernel::Implementation::simd ? "simd" : "scalar";
+            m.blockSize = numSamples;
+            m.voices = VoiceLanes::numLanes;
+            m.osc1 = waveNames[1];
+            m.osc2 = waveNames[1];
+            m.filter = filterNames[0];
+            m.nsPerSample = timeBest (settings, numSamples, [&, stereo = stereo] (int n)
+            {
+                std::fill (output.begin(), output.end(), 0.0f);
+                std::fill (outputRight.begin(), outputRight.end(), 0.0f);
+                VoiceKernel::render (implementation, lanes, voice, allGroups, output.data(), stereo ? outputRight.data() : nullptr, n);
+            });
+
+            results.push_back (m);
+        }
+
+        // Filter coefficient updates happen once per control interval; the
+        // cost is reported spread over the samples of that interval
+        FilterCoefficients next;
+
+        for (auto [name, accuracy] : { std::pair { "filterControl", FastMath::Accuracy::exact },
+                                       std::pair { "filterControl draft", FastMath::Accuracy::draft } })
+        {
+            Measurement m;
+            m.suite = "kernel";
+            m.name = name;
+            m.blockSize = filterControl.getControlInterval();
+
+            filterControl.setAccuracy (accuracy);
+
+            auto step = 0;
+            m.nsPerSample = timeBest (settings, filterControl.getControlInterval(), [&] (int)
+            {
+                // Keep the targets moving like an LFO would, so every step recomputes
+                filterControl.setTargets ((++step & 1) != 0 ? 800.0f : 1200.0f, 0.7f);
+                next = filterControl.getNextControlStep (increment);
+            });
+
+            results.push_back (m);
+        }
+
+        // With the cutoff or resonance modulated, every voice also gets its
+        // own coefficients at each control point, as the voice pool does it
+        {
+            Measurement m;
+            m.suite = "kernel";
+            m.name = "filterControl per voice";
+            m.blockSize = filterControl.getControlInterval();
+            m.voices = VoiceLanes::numLanes;
+
+            filterControl.setAccuracy (FastMath::Accuracy::draft);
+
+            auto step = 0;
+            m.nsPerSample = timeBest (settings, filterControl.getControlInterval(), [&] (int)
+            {
+                const auto octaves = (++step & 1) != 0 ? 0.5f : -0.5f;
+
+                for (int i = 0; i < VoiceLanes::numLanes; ++i)
+                {
+                    const auto cutoff = 1000.0f * FastMath::exp2 (FastMath::Accuracy::draft, octaves * (float) i / VoiceLanes::numLanes);
+                    lanes.setFilter (0, i, filterControl.calculate (cutoff, 0.7f), increment);
+                }
+            });
+
+            results.push_back (m);
+        }
+    }
+
+    //==============================================================================
+    /** Complete panned voices for every combination of the built-in shapes and
+        filter types, rendered by the kernel specialised for that combination
+        and by the generic one. Both run on the same starting state, and their
+        outputs are compared along the way; they should never differ.
+    */
+    void benchmarkDispatch (const Settings& settings, std::vector<Measurement>& results)
+    {
+        constexpr int numSamples = 256;
+
+        WavetableBank wavetables;
+        wavetables.prepare (benchmarkSampleRate);
+
+        FilterControl filterControl;
+        filterControl.prepare (benchmarkSampleRate, FilterControl::defaultControlInterval);
+        filterControl.reset (1000.0f, 0.7f);
+
+        FilterCoefficients increment;
+        const auto coefficients = filterControl.getNextControlStep (increment);
+
+        VoiceKernelParameters params;
+        params.accuracy = FastMath::Accuracy::draft;
+
+        const auto implementation = VoiceKernel::getBestImplementation();
+        const auto allGroups = (1u << (VoiceLanes::numLanes / VoiceKernel::getLanesPerGroup())) - 1;
+
+        VoiceLanes lanes;
+        std::vector<float> left (numSamples), right (numSamples);
+
+        auto render = [&] (VoiceKernel::Dispatch dispatch, int n)
+        {
+            std::fill (left.begin(), left.end(), 0.0f);
+            std::fill (right.begin(), right.end(), 0.0f);
+            VoiceKernel::render (implementation, lanes, params, allGroups, left.data(), right.data(), n, dispatch);
+        };
+
+        for (int osc1 = 0; osc1 < WavetableBank::user; ++osc1)
+        {
+            for (int osc2 = 0; osc2 < WavetableBank::user; ++osc2)
+            {
+                for (int filter = 0; filter < filterNames.size(); ++filter)
+                {
+                    params.osc1WaveType = osc1;
+                    params.osc2WaveType = osc2;
+                    params.filterType = filter;
+
+                    Measurement m;
+                    m.suite = "dispatch";
+                    m.implementation = implementation == VoiceKernel::Implementation::simd ? "simd" : "scalar";
+                    m.blockSize = numSamples;
+                    m.voices = VoiceLanes::numLanes;
+                    m.osc1 = waveNames[osc1];
+                    m.osc2 = waveNames[osc2];
+                    m.filter = filterNames[filter];
+
+                    // One block through each from the same state, for the deviation
+                    initialiseLanes (lanes, wavetables, osc1, osc2, coefficients);
+                    render (VoiceKernel::Dispatch::generic, numSamples);
+                    const auto genericLeft = left, genericRight = right;
+
+                    initialiseLanes (lanes, wavetables, osc1, osc2, coefficients);
+                    render (VoiceKernel::Dispatch::specialised, numSamples);
+
+                    for (int i = 0; i < numSamples; ++i)
+                        m.maxDeviation = juce::jmax (m.maxDeviation,
+                                                     (double) std::abs (left[(size_t) i] - genericLeft[(size_t) i]),
+                                                     (double) std::abs (right[(size_t) i] - genericRight[(size_t) i]));
+
+                    auto generic = m;
+                    generic.name = "generic";
+                    generic.nsPerSample = timeBest (settings, numSamples, [&] (int n) { render (VoiceKernel::Dispatch::generic, n); });
+
+                    m.name = "specialised";
+                    m.nsPerSample = timeBest (settings, numSamples, [&] (int n) { render (VoiceKernel::Dispatch::specialised, n); });
+                    m.speedup = generic.nsPerSample / m.nsPerSample;
+
+                    results.push_back (generic);
+                    results.push_back (m);
+                }
+            }
+
+            std::cerr << "." << std::flush;
+        }
+    }
+
+    //==============================================================================
+    /** How long opening an editor keeps the message thread busy: the
+        constructor, which the host waits for, and filling in the panels, which
+        normally happens over the message loop turns after it. The first editor
+        of the process pays for fonts and look and feel setup, so it's reported
+        on its own, the rest as the best of the repeats.
+    */
+    void benchmarkEditor (const Settings& settings, std::vector<Measurement>& results)
+    {
+        AudioPluginAudioProcessor processor;
+        AudioPluginAudioProcessorEditor::OpenTimings first, best { std::numeric_limits<double>::max(), 0.0, std::numeric_limits<double>::max() };
+
+        for (int repeat = 0; repeat <= settings.repeats; ++repeat)
+        {
+            std::unique_ptr<juce::AudioProcessorEditor> editor (processor.createEditor());
+            auto& pluginEditor = static_cast<AudioPluginAudioProcessorEditor&> (*editor);
+            pluginEditor.populateAll();
+
+            const auto& timings = pluginEditor.getOpenTimings();
+
+            if (repeat == 0)
+            {
+                first = timings;
+                continue;
+            }
+
+            best.constructed = juce::jmin (best.constructed, timings.constructed);
+            best.populated = juce::jmin (best.populated, timings.populated);
+        }
+
+        for (auto [name, milliseconds] : { std::pair { "first constructed", first.constructed },
+                                           std::pair { "first populated", first.populated },
+                                           std::pair { "constructed", best.constructed },
+                                           std::pair { "populated", best.populated } })
+        {
+            Measurement m;
+            m.suite = "editor";
+            m.name = name;
+            m.milliseconds = milliseconds;
+            results.push_back (m);
+        }
+
+        std::cerr << "." << std::flush;
+    }
+
+    //==============================================================================
+    /** Sweeps the FastMath functions over the ranges the parameters reach and
+        compares them with the std:: functions in double precision. Returns
+        false if any error is above the bound documented in FastMath.h.
+    */
+    bool checkFastMath()
+    {
+        using FastMath::Accuracy;
+
+        AudioPluginAudioProcessor processor;
+        const auto cutoffRange = processor.apvts.getParameter (AudioPluginAudioProcessor::FILTER_CUTOFF)->getNormalisableRange();
+        bool passed = true;
+
+        auto report = [&passed] (const char* name, Accuracy accuracy, double error, double bound)
+        {
+            std::cout << juce::String (name).paddedRight (' ', 8) << (accuracy == Accuracy::draft ? "draft   " : "exact   ")
+                      << "max error " << juce::String (error, 3, true) << "   bound " << juce::String (bound, 2, true)
+                      << (error <= bound ? "   ok" : "   FAILED") << std::endl;
+
+            passed = passed && error <= bound;
+        };
+
+        for (auto [accuracy, sinBound, tanBound, exp2Bound, expBound] : { std::tuple { Accuracy::draft, 1.2e-4, 2.5e-4, 8.0e-5, 8.0e-5 },
+                                                                            std::tuple { Accuracy::exact, 2.5e-7, 4.0e-7, 3.0e-7, 2.0e-6 } })
+        {
+            // Oscillator and LFO phases, absolute error, through the vector
+            // instantiation too where this build has one
+            constexpr int numPhases = 1 << 22;
+            double sinError = 0.0;
+
+            for (int i = 0; i < numPhases; ++i)
+            {
+                const auto phase = (float) i / (float) numPhases;
+                const auto expected = std::sin (juce::MathConstants<double>::twoPi * phase);
+                sinError = juce::jmax (sinError, std::abs (FastMath::sin2Pi (accuracy, phase) - expected));
+
+               #if JUCE_USE_SIMD
+                using Vec = juce::dsp::SIMDRegister<float>;
+                const auto vector = accuracy == Accuracy::draft ? FastMath::sin2Pi<Accuracy::draft> (Vec::expand (phase))
+                                                                : FastMath::sin2Pi<Accuracy::exact> (Vec::expand (phase));
+                sinError = juce::jmax (sinError, std::abs (vector.get (0) - expected));
+               #endif
+            }
+
+            report ("sin2Pi", accuracy, sinError, sinBound);
+
+            // Filter prewarping across the cutoff parameter's range, at the
+            // sample rates hosts run us at, relative error
+            double tanError = 0.0;
+
+            for (auto rate : { 22050.0, 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 })
+            {
+                for (int i = 0; i <= 100000; ++i)
+                {
+                    const auto cutoff = juce::jmin ((double) cutoffRange.convertFrom0to1 ((float) i / 100000.0f), 0.49 * rate);
+                    const auto x = (float) (juce::MathConstants<double>::pi * cutoff / rate);
+                    const auto expected = std::tan ((double) x);
+                    tanError = juce::jmax (tanError, std::abs (FastMath::tan (accuracy, x) - expected) / expected);
+                }
+            }
+
+            report ("tan", accuracy, tanError, tanBound);
+
+            // Nothing uses these on the audio path yet, so they are checked
+            // over their whole documented range
+            double exp2Error = 0.0, expError = 0.0;
+
+            for (int i = 0; i <= 1000000; ++i)
+            {
+                const auto x2 = (float) (-126.0 + 253.0 * i / 1000000.0);
+                const auto x = (float) (-16.0 + 32.0 * i / 1000000.0);
+                exp2Error = juce::jmax (exp2Error, std::abs (FastMath::exp2 (accuracy, x2) / std::exp2 ((double) x2) - 1.0));
+                expError = juce::jmax (expError, std::abs (FastMath::exp (accuracy, x) / std::exp ((double) x) - 1.0));
+            }
+
+            report ("exp2", accuracy, exp2Error, exp2Bound);
+            report ("exp", accuracy, expError, expBound);
+        }
+
+        return passed;
+    }
+
+    //==============================================================================
+    juce::String toCsv (const std::vector<Measurement>& results)
+    {
+        juce::String csv = "suite,name,implementation,precision,blockSize,voices,threads,unison,osc1,osc2,filter,lfo,nsPerSample,maxDeviation,speedup,milliseconds\n";
+
+        for (auto& m : results)
+            csv << m.suite << "," << m.name << "," << m.implementation << "," << m.precision << "," << m.blockSize << "," << m.voices << ","
+                << m.threads << "," << m.unison << "," << m.osc1 << "," << m.osc2 << "," << m.filter << "," << (m.lfo ? "on" : "off") << ","
+                << juce::String (m.nsPerSample, 3) << "," << juce::String (m.maxDeviation) << "," << juce::String (m.speedup, 3) << "," << juce::String (m.milliseconds, 3) << "\n";
+
+        return csv;
+    }
+
+    juce::String toJson (const std::vector<Measurement>& results)
+    {
+        juce::Array<juce::var> list;
+
+        for (auto& m : results)
+        {
+            auto* object = new juce::DynamicObject();
+            object->setProperty ("suite", m.suite);
+            object->setProperty ("name", m.name);
+            object->setProperty ("implementation", m.implementation);
+            object->setProperty ("precision", m.precision);
+            object->setProperty ("blockSize", m.blockSize);
+            object->setProperty ("voices", m.voices);
+            object->setProperty ("threads", m.threads);
+            object->setProperty ("unison", m.unison);
+            object->setProperty ("osc1", m.osc1);
+            object->setProperty ("osc2", m.osc2);
+            object->setProperty ("filter", m.filter);
+            object->setProperty ("lfo", m.lfo);
+            object->setProperty ("nsPerSample", m.nsPerSample);
+            object->setProperty ("maxDeviation", m.maxDeviation);
+            object->setProperty ("speedup", m.speedup);
+            object->setProperty ("milliseconds", m.milliseconds);
+            list.add (juce::var (object));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("sampleRate", benchmarkSampleRate);
+        root->setProperty ("simd", VoiceKernel::getBestImplementation() == VoiceKernel::Implementation::simd);
+        root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty ("cores", juce::SystemStats::getNumCpus());
+        root->setProperty ("results", list);
+
+        return juce::JSON::toString (juce::var (root));
+    }
+
+    juce::Array<int> parseList (const juce::String& text)
+    {
+        juce::Array<int> values;
+
+        for (auto& token : juce::StringArray::fromTokens (text, ",", {}))
+            if (token.getIntValue() > 0)
+                values.add (token.getIntValue());
+
+        return values;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << "Usage: JuceNeutronBenchmark [options]\n"
+                     "       JuceNeutronBenchmark --check-math\n\n"
+                     "  --suite=<all|processBlock|kernel|threads|precision|dispatch|editor>\n"
+                     "  --blocks=<n,n,...>    block sizes for processBlock (default 16 to 4096)\n"
+                     "  --voices=<n,n,...>    held voices for processBlock (default 1,4,8,16)\n"
+                     "  --threads=<n,n,...>   voice worker threads for the threads suite (default 0,1,2,3)\n"
+                     "  --seconds=<s>         audio rendered per timed run (default 0.2)\n"
+                     "  --repeats=<n>         timed runs per case, the fastest counts (default 3)\n"
+                     "  --format=<json|csv>   (default json)\n"
+                     "  --out=<file>          write results there instead of stdout\n\n"
+                     "--check-math compares the fast math approximations with the std:: functions\n"
+                     "and exits with 1 if any is off by more than its documented bound.\n";
+        return 0;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    if (args.containsOption ("--check-math"))
+        return checkFastMath() ? 0 : 1;
+
+    Settings settings;
+    const auto suite = args.getValueForOption ("--suite");
+    settings.runProcessBlock = suite.isEmpty() || suite == "all" || suite == "processBlock";
+    settings.runKernels = suite.isEmpty() || suite == "all" || suite == "kernel";
+    settings.runThreads = suite.isEmpty() || suite == "all" || suite == "threads";
+    settings.runPrecision = suite.isEmpty() || suite == "all" || suite == "precision";
+    settings.runDispatch = suite.isEmpty() || suite == "all" || suite == "dispatch";
+    settings.runEditor = suite.isEmpty() || suite == "all" || suite == "editor";
+
+    if (args.containsOption ("--blocks"))
+        settings.blockSizes = parseList (args.getValueForOption ("--blocks"));
+
+    if (args.containsOption ("--voices"))
+        settings.voiceCounts = parseList (args.getValueForOption ("--voices"));
+
+    if (args.containsOption ("--threads"))
+    {
+        // parseList drops zeros, which are a valid count here
+        settings.threadCounts.clear();
+
+        for (auto& token : juce::StringArray::fromTokens (args.getValueForOption ("--threads"), ",", {}))
+            settings.threadCounts.add (juce::jmax (0, token.getIntValue()));
+    }
+
+    if (args.containsOption ("--seconds"))
+        settings.seconds = juce::jmax (0.001, args.getValueForOption ("--seconds").getDoubleValue());
+
+    if (args.containsOption ("--repeats"))
+        settings.repeats = juce::jmax (1, args.getValueForOption ("--repeats").getIntValue());
+
+    std::vector<Measurement> results;
+
+    if (settings.runKernels)
+        benchmarkKernels (settings, results);
+
+    if (settings.runProcessBlock)
+        benchmarkProcessBlock (settings, results);
+
+    if (settings.runThreads)
+        benchmarkThreads (settings, results);
+
+    if (settings.runPrecision)
+        benchmarkPrecision (settings, results);
+
+    if (settings.runDispatch)
+        benchmarkDispatch (settings, results);
+
+    if (settings.runEditor)
+        benchmarkEditor (settings, results);
+
+    std::cerr << std::endl;
+
+    const auto text = args.getValueForOption ("--format") == "csv" ? toCsv (results) : toJson (results);
+
+    if (args.containsOption ("--out"))
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--out").unquoted());
+
+        if (! file.replaceWithText (text))
+        {
+            std::cerr << "Error: couldn't write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << text << std::endl;
+    }
+
+    return 0;
+}
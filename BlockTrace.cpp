@@ -0,0 +1,208 @@
+#include "BlockTrace.h"
+
+//==============================================================================
+template <int numWords>
+BlockTrace::Ring<numWords>::Ring (int capacity)
+    : slots ((size_t) capacity), mask ((juce::uint64) capacity - 1)
+{
+    jassert (juce::isPowerOfTwo (capacity));
+}
+
+template <int numWords>
+void BlockTrace::Ring<numWords>::push (const Words& words) noexcept
+{
+    const auto number = written.load (std::memory_order_relaxed) + 1;
+    auto& slot = slots[(size_t) (number & mask)];
+
+    slot.number.store (0, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    for (size_t i = 0; i < words.size(); ++i)
+        slot.words[i].store (words[i], std::memory_order_relaxed);
+
+    slot.number.store (number, std::memory_order_release);
+    written.store (number, std::memory_order_release);
+}
+
+template <int numWords>
+void BlockTrace::Ring<numWords>::clear() noexcept
+{
+    for (auto& slot : slots)
+        slot.number.store (0, std::memory_order_relaxed);
+
+    written.store (0, std::memory_order_release);
+}
+
+template <int numWords>
+template <typename Callback>
+void BlockTrace::Ring<numWords>::read (Callback&& callback) const
+{
+    const auto last = written.load (std::memory_order_acquire);
+    const auto first = last > mask ? last - mask : 1;
+
+    for (auto number = first; number <= last; ++number)
+    {
+        const auto& slot = slots[(size_t) (number & mask)];
+
+        if (slot.number.load (std::memory_order_acquire) != number)
+            continue;
+
+        Words words;
+
+        for (size_t i = 0; i < words.size(); ++i)
+            words[i] = slot.words[i].load (std::memory_order_relaxed);
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (slot.number.load (std::memory_order_relaxed) == number)
+            callback (words);
+    }
+}
+
+//==============================================================================
+BlockTrace::BlockTrace() = default;
+
+void BlockTrace::addBlock (const Block& block) noexcept
+{
+    blocks.push ({ block.startTicks,
+                   block.endTicks,
+                   (juce::int64) ((juce::uint64) (juce::uint32) block.numSamples << 32 | (juce::uint32) block.numMidiEvents),
+                   (juce::int64) block.activeVoices << 1 | (block.skipped ? 1 : 0) });
+}
+
+void BlockTrace::addSpan (const Span& span) noexcept
+{
+   #if NEUTRON_TRACE_STAGES
+    spans.push ({ span.startTicks, span.endTicks, (juce::int64) span.stage });
+   #else
+    juce::ignoreUnused (span);
+   #endif
+}
+
+void BlockTrace::clear() noexcept
+{
+    blocks.clear();
+
+   #if NEUTRON_TRACE_STAGES
+    spans.clear();
+   #endif
+}
+
+std::vector<BlockTrace::Block> BlockTrace::getBlocks() const
+{
+    std::vector<Block> result;
+    result.reserve ((size_t) blockCapacity);
+
+    blocks.read ([&result] (const auto& words)
+    {
+        Block block;
+        block.startTicks = words[0];
+        block.endTicks = words[1];
+        block.numSamples = (int) (juce::uint32) ((juce::uint64) words[2] >> 32);
+        block.numMidiEvents = (int) (juce::uint32) words[2];
+        block.activeVoices = (int) (words[3] >> 1);
+        block.skipped = (words[3] & 1) != 0;
+        result.push_back (block);
+    });
+
+    return result;
+}
+
+std::vector<BlockTrace::Span> BlockTrace::getSpans() const
+{
+    std::vector<Span> result;
+
+   #if NEUTRON_TRACE_STAGES
+    result.reserve ((size_t) spanCapacity);
+
+    spans.read ([&result] (const auto& words)
+    {
+        result.push_back ({ words[0], words[1], (Stage) words[2] });
+    });
+   #endif
+
+    return result;
+}
+
+//==============================================================================
+namespace
+{
+    const char* getStageName (BlockTrace::Stage stage)
+    {
+        switch (stage)
+        {
+            case BlockTrace::Stage::parameters:     return "parameters";
+            case BlockTrace::Stage::filter:         return "filter";
+            case BlockTrace::Stage::voices:         return "voices";
+            case BlockTrace::Stage::output:         return "output";
+        }
+
+        return "unknown";
+    }
+}
+
+void BlockTrace::writeChromeTrace (juce::OutputStream& out) const
+{
+    const auto blockList = getBlocks();
+    const auto spanList = getSpans();
+    const auto sampleRate = currentSampleRate.load();
+
+    // Microseconds since the oldest record, which is what the format expects
+    auto origin = std::numeric_limits<juce::int64>::max();
+
+    for (const auto& block : blockList)
+        origin = juce::jmin (origin, block.startTicks);
+
+    for (const auto& span : spanList)
+        origin = juce::jmin (origin, span.startTicks);
+
+    auto toMicroseconds = [] (juce::int64 ticks)
+    {
+        return juce::String (juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e6, 3);
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"" << JucePlugin_Name << "\"}},\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Audio\"}}";
+
+    for (const auto& block : blockList)
+    {
+        const auto seconds = juce::Time::highResolutionTicksToSeconds (block.endTicks - block.startTicks);
+        const auto load = sampleRate > 0.0 && block.numSamples > 0 ? seconds * sampleRate / block.numSamples : 0.0;
+        const auto start = toMicroseconds (block.startTicks - origin);
+
+        out << ",\n{\"name\":\"" << (block.skipped ? "skipped" : "processBlock") << "\",\"cat\":\"block\",\"ph\":\"X\""
+            << ",\"pid\":1,\"tid\":1,\"ts\":" << start << ",\"dur\":" << toMicroseconds (block.endTicks - block.startTicks)
+            << ",\"args\":{\"samples\":" << block.numSamples << ",\"midiEvents\":" << block.numMidiEvents
+            << ",\"voices\":" << block.activeVoices << ",\"load\":" << juce::String (load, 4) << "}}"
+            << ",\n{\"name\":\"voices\",\"ph\":\"C\",\"pid\":1,\"ts\":" << start
+            << ",\"args\":{\"voices\":" << block.activeVoices << "}}";
+
+        if (load > 1.0)
+            out << ",\n{\"name\":\"deadline missed\",\"cat\":\"block\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":1,\"ts\":" << start << "}";
+    }
+
+    for (const auto& span : spanList)
+    {
+        out << ",\n{\"name\":\"" << getStageName (span.stage) << "\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+            << ",\"ts\":" << toMicroseconds (span.startTicks - origin)
+            << ",\"dur\":" << toMicroseconds (span.endTicks - span.startTicks) << "}";
+    }
+
+    out << "\n]}\n";
+}
+
+juce::Result BlockTrace::writeChromeTrace (const juce::File& file) const
+{
+    juce::FileOutputStream out (file);
+
+    if (out.failedToOpen())
+        return juce::Result::fail ("Couldn't write " + file.getFullPathName() + ": " + out.getStatus().getErrorMessage());
+
+    out.setPosition (0);
+    out.truncate();
+    writeChromeTrace (out);
+    out.flush();
+
+    return out.getStatus();
+}
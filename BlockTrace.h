@@ -0,0 +1,181 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#ifndef NEUTRON_TRACE_STAGES
+ #define NEUTRON_TRACE_STAGES 0
+#endif
+
+//==============================================================================
+/** An always-on flight recorder of the audio thread's blocks.
+
+    Every processBlock leaves one Block behind: when it started, how long it
+    took, its size, MIDI events and voices, and whether it was skipped. The
+    most recent blockCapacity of them are kept in a lock-free ring that the
+    audio thread only ever overwrites, so recording costs a few stores per
+    block and nothing waits for a reader. Any thread can copy the ring out at
+    any time, e.g. to export it as a Chrome trace after a dropout.
+
+    With NEUTRON_TRACE_STAGES enabled (the NEUTRON_TRACE_STAGES CMake option)
+    the stages inside each block are recorded too, as Spans. Without it,
+    SpanScope is empty and compiles away.
+*/
+class BlockTrace
+{
+public:
+    BlockTrace();
+
+    struct Block
+    {
+        juce::int64 startTicks = 0;     // juce::Time high resolution ticks
+        juce::int64 endTicks = 0;
+        int numSamples = 0;
+        int numMidiEvents = 0;
+        int activeVoices = 0;
+        bool skipped = false;           // nothing was rendered, master off or idle
+    };
+
+    enum class Stage
+    {
+        parameters,     // the parameter tick, LFO and settings for the voices
+        filter,         // filter coefficients at control rate
+        voices,         // oscillators, filter and envelopes, in one kernel pass
+        output          // copying the voices to the output and the preset crossfade
+    };
+
+    struct Span
+    {
+        juce::int64 startTicks = 0;
+        juce::int64 endTicks = 0;
+        Stage stage = Stage::voices;
+    };
+
+    static constexpr int blockCapacity = 1 << 14;
+    static constexpr int spanCapacity = 1 << 16;
+
+    static constexpr bool hasStages()   { return NEUTRON_TRACE_STAGES != 0; }
+
+    //==============================================================================
+    /** Audio thread. */
+    void addBlock (const Block& block) noexcept;
+    void addSpan (const Span& span) noexcept;
+
+    /** Sets the sample rate the blocks' durations are compared with. */
+    void prepare (double sampleRate) noexcept   { currentSampleRate.store (sampleRate); }
+
+    /** Forgets everything recorded. Only while nothing is recording. */
+    void clear() noexcept;
+
+    //==============================================================================
+    /** Any thread. Copies out what's in the ring, oldest first. */
+    std::vector<Block> getBlocks() const;
+    std::vector<Span> getSpans() const;
+
+    /** Writes the blocks and spans in the Chrome trace event format, which
+        chrome://tracing and Perfetto open.
+    */
+    void writeChromeTrace (juce::OutputStream&) const;
+    juce::Result writeChromeTrace (const juce::File&) const;
+
+    //==============================================================================
+    /** Records processBlock for the lifetime of the scope. */
+    class BlockScope
+    {
+    public:
+        BlockScope (BlockTrace& t, int numSamples, int numMidiEvents) noexcept
+            : trace (t)
+        {
+            block.startTicks = juce::Time::getHighResolutionTicks();
+            block.numSamples = numSamples;
+            block.numMidiEvents = numMidiEvents;
+        }
+
+        ~BlockScope()
+        {
+            block.endTicks = juce::Time::getHighResolutionTicks();
+            trace.addBlock (block);
+        }
+
+        void setActiveVoices (int numVoices) noexcept   { block.activeVoices = numVoices; }
+        void setSkipped() noexcept                      { block.skipped = true; }
+
+    private:
+        BlockTrace& trace;
+        Block block;
+
+        JUCE_DECLARE_NON_COPYABLE (BlockScope)
+    };
+
+    /** Records one stage for the lifetime of the scope, in builds with
+        NEUTRON_TRACE_STAGES. Only on the audio thread; trace may be nullptr.
+    */
+    class SpanScope
+    {
+    public:
+       #if NEUTRON_TRACE_STAGES
+        SpanScope (BlockTrace* t, Stage stage) noexcept
+            : trace (t)
+        {
+            span.stage = stage;
+            span.startTicks = juce::Time::getHighResolutionTicks();
+        }
+
+        ~SpanScope()
+        {
+            if (trace != nullptr)
+            {
+                span.endTicks = juce::Time::getHighResolutionTicks();
+                trace->addSpan (span);
+            }
+        }
+
+    private:
+        BlockTrace* trace;
+        Span span;
+       #else
+        SpanScope (BlockTrace*, Stage) noexcept {}
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (SpanScope)
+    };
+
+private:
+    //==============================================================================
+    /** Single writer, any number of readers. Each slot carries the number of
+        the record in it, which readers check before and after copying, so a
+        slot overwritten while it was read is skipped rather than torn.
+    */
+    template <int numWords>
+    class Ring
+    {
+    public:
+        using Words = std::array<juce::int64, (size_t) numWords>;
+
+        explicit Ring (int capacity);
+
+        void push (const Words& words) noexcept;
+        void clear() noexcept;
+
+        template <typename Callback>
+        void read (Callback&& callback) const;
+
+    private:
+        struct Slot
+        {
+            std::atomic<juce::uint64> number { 0 };     // 0 while empty or being written
+            std::array<std::atomic<juce::int64>, (size_t) numWords> words {};
+        };
+
+        std::vector<Slot> slots;
+        const juce::uint64 mask;
+        std::atomic<juce::uint64> written { 0 };
+    };
+
+    Ring<4> blocks { blockCapacity };
+
+   #if NEUTRON_TRACE_STAGES
+    Ring<3> spans { spanCapacity };
+   #endif
+
+    std::atomic<double> currentSampleRate { 44100.0 };
+};
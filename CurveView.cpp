@@ -0,0 +1,284 @@
+#include "CurveView.h"
+
+//==============================================================================
+bool CurveBuilder::Inputs::operator== (const Inputs& other) const noexcept
+{
+    return attack == other.attack && decay == other.decay && sustain == other.sustain && release == other.release
+        && filterType == other.filterType && cutoff == other.cutoff && resonance == other.resonance
+        && variesPerVoice == other.variesPerVoice && sampleRate == other.sampleRate;
+}
+
+//==============================================================================
+CurveBuilder::CurveBuilder (AudioPluginAudioProcessor& p)
+    : juce::Thread ("Curve Builder"),
+      processor (p),
+      attack (p.apvts.getRawParameterValue (AudioPluginAudioProcessor::ATTACK)),
+      decay (p.apvts.getRawParameterValue (AudioPluginAudioProcessor::DECAY)),
+      sustain (p.apvts.getRawParameterValue (AudioPluginAudioProcessor::SUSTAIN)),
+      release (p.apvts.getRawParameterValue (AudioPluginAudioProcessor::RELEASE)),
+      filterType (p.apvts.getRawParameterValue (AudioPluginAudioProcessor::FILTER_TYPE)),
+      filterCutoff (p.apvts.getRawParameterValue (AudioPluginAudioProcessor::FILTER_CUTOFF)),
+      filterResonance (p.apvts.getRawParameterValue (AudioPluginAudioProcessor::FILTER_RESONANCE)),
+      lfoDepth (p.apvts.getRawParameterValue (AudioPluginAudioProcessor::LFO_DEPTH))
+{
+    for (size_t i = 0; i < (size_t) ModulationMatrix::maxRoutes; ++i)
+    {
+        modSource[i] = p.apvts.getRawParameterValue (AudioPluginAudioProcessor::MOD_SOURCE[i]);
+        modDestination[i] = p.apvts.getRawParameterValue (AudioPluginAudioProcessor::MOD_DESTINATION[i]);
+        modDepth[i] = p.apvts.getRawParameterValue (AudioPluginAudioProcessor::MOD_DEPTH[i]);
+    }
+
+    startThread (juce::Thread::Priority::low);
+}
+
+CurveBuilder::~CurveBuilder()
+{
+    stopThread (1000);
+}
+
+std::shared_ptr<const CurveBuilder::Curves> CurveBuilder::getLatest() const
+{
+    const juce::SpinLock::ScopedLockType lock (publishLock);
+    return latest;
+}
+
+void CurveBuilder::run()
+{
+    Inputs previous;
+    bool first = true;
+    int intervalMs = fastIntervalMs;
+
+    while (! threadShouldExit())
+    {
+        const auto inputs = readInputs();
+
+        if (first || inputs != previous)
+        {
+            auto curves = build (inputs);
+
+            {
+                const juce::SpinLock::ScopedLockType lock (publishLock);
+                std::swap (latest, curves);
+            }
+
+            // The old curves, if nobody else holds them, are freed here
+            // rather than inside the lock
+            curves.reset();
+
+            previous = inputs;
+            first = false;
+            intervalMs = fastIntervalMs;
+        }
+        else
+        {
+            intervalMs = juce::jmin (intervalMs * 2, slowIntervalMs);
+        }
+
+        wait (intervalMs);
+    }
+}
+
+CurveBuilder::Inputs CurveBuilder::readInputs() const
+{
+    Inputs inputs;
+    inputs.attack = attack->load();
+    inputs.decay = decay->load();
+    inputs.sustain = sustain->load();
+    inputs.release = release->load();
+    inputs.filterType = (int) filterType->load();
+    inputs.resonance = juce::jmax (0.01f, filterResonance->load());
+    inputs.sampleRate = processor.getTelemetry().getSampleRate();
+
+    // The same modulation as the processor applies, so the curve follows the
+    // LFO while the processor runs
+    const auto cutoff = filterCutoff->load();
+    inputs.cutoff = juce::jlimit (20.0f, 20000.0f, cutoff + processor.getLfoValue() * lfoDepth->load() * cutoff);
+
+    for (size_t i = 0; i < (size_t) ModulationMatrix::maxRoutes; ++i)
+    {
+        using Matrix = ModulationMatrix;
+        const auto source = static_cast<Matrix::Source> ((int) modSource[i]->load());
+        const auto destination = static_cast<Matrix::Destination> ((int) modDestination[i]->load());
+
+        if (source != Matrix::Source::none && modDepth[i]->load() != 0.0f
+             && (destination == Matrix::Destination::cutoff || destination == Matrix::Destination::resonance))
+            inputs.variesPerVoice = true;
+    }
+
+    return inputs;
+}
+
+std::shared_ptr<const CurveBuilder::Curves> CurveBuilder::build (const Inputs& inputs)
+{
+    auto curves = std::make_shared<Curves>();
+    curves->inputs = inputs;
+
+    // Envelope: linear segments, with the sustain held for a while in between
+    // so that it shows
+    {
+        const auto hold = juce::jmax (0.2f, 0.25f * (inputs.attack + inputs.decay + inputs.release));
+        const auto total = inputs.attack + inputs.decay + hold + inputs.release;
+        const auto sustainY = 1.0f - inputs.sustain;
+
+        auto& path = curves->envelope;
+        auto time = 0.0f;
+        path.startNewSubPath (0.0f, 1.0f);
+        path.lineTo ((time += inputs.attack) / total, 0.0f);
+        path.lineTo ((time += inputs.decay) / total, sustainY);
+        path.lineTo ((time += hold) / total, sustainY);
+        path.lineTo (1.0f, 1.0f);
+    }
+
+    // Filter: the TPT state variable filter's response is the analogue one's
+    // on a prewarped frequency axis, so it's exact up to Nyquist
+    {
+        const auto sampleRate = juce::jmax (1000.0, inputs.sampleRate);
+        const auto nyquist = juce::jmin ((double) maxFrequency, 0.5 * sampleRate);
+        const auto pi = juce::MathConstants<double>::pi;
+        const auto g = std::tan (pi * juce::jmin ((double) inputs.cutoff, 0.49 * sampleRate) / sampleRate);
+        const auto R2 = 1.0 / inputs.resonance;
+        const auto logRange = std::log ((double) maxFrequency / minFrequency);
+
+        auto toY = [] (double decibels)
+        {
+            return (float) juce::jlimit (0.0, 1.0, (maxDecibels - decibels) / (maxDecibels - minDecibels));
+        };
+
+        auto& path = curves->response;
+
+        for (int i = 0; i < numResponsePoints; ++i)
+        {
+            const auto x = (double) i / (numResponsePoints - 1);
+            const auto frequency = minFrequency * std::exp (x * logRange);
+
+            if (frequency >= nyquist)
+                break;
+
+            const auto w = std::tan (pi * frequency / sampleRate) / g;
+            const auto denominator = std::sqrt ((1.0 - w * w) * (1.0 - w * w) + (R2 * w) * (R2 * w));
+            const auto numerator = inputs.filterType == 0 ? 1.0
+                                 : inputs.filterType == 1 ? w
+                                                          : w * w;
+
+            const auto y = toY (juce::Decibels::gainToDecibels (numerator / denominator, (double) minDecibels - 1.0));
+
+            if (i == 0)
+                path.startNewSubPath ((float) x, y);
+            else
+                path.lineTo ((float) x, y);
+        }
+
+        curves->cutoffPosition = (float) (std::log ((double) inputs.cutoff / minFrequency) / logRange);
+        curves->unityPosition = toY (0.0);
+    }
+
+    return curves;
+}
+
+//==============================================================================
+CurveView::CurveView (AudioPluginAudioProcessor& p)
+    : builder (p)
+{
+    setOpaque (true);
+    startTimer (intervalMs);
+}
+
+void CurveView::timerCallback()
+{
+    auto latest = builder.getLatest();
+
+    if (latest != curves)
+    {
+        curves = std::move (latest);
+        image = {};
+        repaint();
+
+        intervalMs = 1000 / framesPerSecond;
+    }
+    else
+    {
+        if (intervalMs >= slowestIntervalMs)
+            return;
+
+        intervalMs = juce::jmin (intervalMs * 2, slowestIntervalMs);
+    }
+
+    startTimer (intervalMs);
+}
+
+//==============================================================================
+void CurveView::paint (juce::Graphics& g)
+{
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (! image.isValid() || ! juce::approximatelyEqual (scale, imageScale))
+        renderImage (scale);
+
+    g.drawImageTransformed (image, juce::AffineTransform::scale (1.0f / imageScale));
+}
+
+void CurveView::resized()
+{
+    image = {};
+}
+
+void CurveView::renderImage (float scale)
+{
+    imageScale = scale;
+    image = juce::Image (juce::Image::RGB, juce::jmax (1, juce::roundToInt ((float) getWidth() * scale)),
+                         juce::jmax (1, juce::roundToInt ((float) getHeight() * scale)), false);
+
+    juce::Graphics g (image);
+    g.addTransform (juce::AffineTransform::scale (scale));
+    g.fillAll (juce::Colours::black);
+
+    auto area = getLocalBounds().toFloat().reduced (4.0f);
+    auto envelopeArea = area.removeFromLeft (area.getWidth() * 0.4f);
+    area.removeFromLeft (6.0f);
+    auto responseArea = area;
+
+    g.setColour (juce::Colours::grey);
+    g.setFont (12.0f);
+    g.drawText ("ENVELOPE", envelopeArea.removeFromTop (16.0f), juce::Justification::centredLeft);
+    g.drawText ("FILTER", responseArea.removeFromTop (16.0f), juce::Justification::centredLeft);
+
+    g.setColour (juce::Colours::darkgrey);
+    g.drawRect (envelopeArea);
+    g.drawRect (responseArea);
+
+    if (curves == nullptr)
+        return;
+
+    auto toArea = [] (juce::Rectangle<float> r)
+    {
+        return juce::AffineTransform::scale (r.getWidth(), r.getHeight()).translated (r.getX(), r.getY());
+    };
+
+    {
+        const auto transform = toArea (envelopeArea.reduced (2.0f));
+        auto fill = curves->envelope;
+        fill.closeSubPath();
+
+        g.setColour (juce::Colours::orange.withAlpha (0.2f));
+        g.fillPath (fill, transform);
+        g.setColour (juce::Colours::orange);
+        g.strokePath (curves->envelope, juce::PathStrokeType (1.5f), transform);
+    }
+
+    {
+        const auto r = responseArea.reduced (0.0f, 2.0f);
+
+        g.setColour (juce::Colours::darkgrey);
+        g.drawHorizontalLine (juce::roundToInt (r.getY() + curves->unityPosition * r.getHeight()), r.getX(), r.getRight());
+        g.drawVerticalLine (juce::roundToInt (r.getX() + curves->cutoffPosition * r.getWidth()), r.getY(), r.getBottom());
+
+        g.setColour (juce::Colours::skyblue);
+        g.strokePath (curves->response, juce::PathStrokeType (1.5f), toArea (r));
+
+        if (curves->inputs.variesPerVoice)
+        {
+            g.setColour (juce::Colours::grey);
+            g.drawText ("Before per-voice modulation", r.reduced (4.0f, 2.0f), juce::Justification::bottomLeft);
+        }
+    }
+}
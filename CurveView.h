@@ -0,0 +1,123 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "PluginProcessor.h"
+
+//==============================================================================
+/** Works out the envelope's shape and the filter's magnitude response on its
+    own thread, from the processor's parameters and its LFO.
+
+    The response is the one all voices share. Modulation routes to the cutoff
+    or resonance move each voice away from it, which is only flagged, as no
+    single curve would show that.
+
+    The curves are only built again when something they depend on has moved,
+    and each set is published whole and never changed after that, so readers
+    can keep drawing one for as long as they like. The thread checks often
+    while things are moving and backs off while they aren't. The audio thread
+    isn't involved beyond the LFO value it publishes anyway.
+*/
+class CurveBuilder final : private juce::Thread
+{
+public:
+    /** Everything the curves depend on. */
+    struct Inputs
+    {
+        float attack = 0.0f;        // seconds
+        float decay = 0.0f;
+        float sustain = 0.0f;       // level
+        float release = 0.0f;
+        int filterType = 0;         // 0 = lowpass, 1 = bandpass, 2 = highpass
+        float cutoff = 0.0f;        // after LFO modulation
+        float resonance = 0.0f;
+        bool variesPerVoice = false;    // a modulation route moves cutoff or resonance
+        double sampleRate = 44100.0;
+
+        bool operator== (const Inputs& other) const noexcept;
+        bool operator!= (const Inputs& other) const noexcept   { return ! operator== (other); }
+    };
+
+    /** Paths in a unit square, y downwards, to be scaled to where they're drawn.
+        The response runs from minFrequency to maxFrequency on a log scale and
+        from maxDecibels to minDecibels.
+    */
+    struct Curves
+    {
+        Inputs inputs;
+        juce::Path envelope;
+        juce::Path response;
+        float cutoffPosition = 0.0f;
+        float unityPosition = 0.0f;     // y of 0 dB
+    };
+
+    explicit CurveBuilder (AudioPluginAudioProcessor&);
+    ~CurveBuilder() override;
+
+    /** The newest curves, nullptr until the first ones are built. Any thread. */
+    std::shared_ptr<const Curves> getLatest() const;
+
+    static constexpr int numResponsePoints = 200;
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+    static constexpr float minDecibels = -48.0f;
+    static constexpr float maxDecibels = 12.0f;
+
+    static constexpr int fastIntervalMs = 15;
+    static constexpr int slowIntervalMs = 120;
+
+private:
+    void run() override;
+    Inputs readInputs() const;
+    static std::shared_ptr<const Curves> build (const Inputs&);
+
+    AudioPluginAudioProcessor& processor;
+    std::atomic<float>* attack;
+    std::atomic<float>* decay;
+    std::atomic<float>* sustain;
+    std::atomic<float>* release;
+    std::atomic<float>* filterType;
+    std::atomic<float>* filterCutoff;
+    std::atomic<float>* filterResonance;
+    std::atomic<float>* lfoDepth;
+    std::array<std::atomic<float>*, ModulationMatrix::maxRoutes> modSource, modDestination, modDepth;
+
+    std::shared_ptr<const Curves> latest;
+    juce::SpinLock publishLock;
+};
+
+//==============================================================================
+/** The envelope's shape and the filter's response, as a CurveBuilder makes
+    them.
+
+    Each new set of curves is drawn once into an image at the physical
+    resolution, and paint() only copies that. The view looks for new curves at
+    up to framesPerSecond while they keep changing, and less and less often
+    while they don't.
+*/
+class CurveView final : public juce::Component,
+                        private juce::Timer
+{
+public:
+    explicit CurveView (AudioPluginAudioProcessor&);
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+    static constexpr int framesPerSecond = 60;
+    static constexpr int slowestIntervalMs = 250;
+
+private:
+    void timerCallback() override;
+    void renderImage (float scale);
+
+    CurveBuilder builder;
+    std::shared_ptr<const CurveBuilder::Curves> curves;
+
+    juce::Image image;
+    float imageScale = 0.0f;
+
+    int intervalMs = 1000 / framesPerSecond;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CurveView)
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+/** Polynomial replacements for the std:: functions on the audio path.
+
+    Each comes in two tiers: draft, for live playing, where errors around
+    -80 dB go unheard and every cycle counts, and exact, which is about as
+    close to the std:: function as float arithmetic gets and is used for
+    offline bounces. The coefficients are minimax fits for relative error.
+
+    Maximum errors, measured against the double precision std:: functions
+    over the ranges the parameters can reach (JuceNeutronBenchmark --check-math
+    sweeps them and fails if any is exceeded):
+
+                        range                               draft       exact
+        sin2Pi          phase in [0, 1), absolute           1.2e-4      2.5e-7
+        tan             x in [0, 0.49 pi], relative         2.5e-4      4.0e-7
+        exp2            x in [-126, 127], relative          8.0e-5      3.0e-7
+        exp             x in [-16, 16], relative            8.0e-5      2.0e-6
+
+    sin2Pi works on plain floats as well as on SIMD registers (anything with
+    the juce::dsp::SIMDRegister interface). The others are branch-free scalar
+    code, which compilers vectorise when they are called in a loop.
+*/
+namespace FastMath
+{
+    enum class Accuracy
+    {
+        draft,
+        exact
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        inline T broadcast (float value) noexcept
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return value;
+            else
+                return T::expand (value);
+        }
+
+        template <typename T>
+        inline T minimum (T a, T b) noexcept
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return a < b ? a : b;
+            else
+                return T::min (a, b);
+        }
+
+        template <typename T>
+        inline T maximum (T a, T b) noexcept
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return a > b ? a : b;
+            else
+                return T::max (a, b);
+        }
+
+        /** sin (x) for x in [-pi/2, pi/2], as x * P (x^2). */
+        template <Accuracy accuracy, typename T>
+        inline T sinHalfPi (T x) noexcept
+        {
+            const auto x2 = x * x;
+            T p;
+
+            if constexpr (accuracy == Accuracy::draft)
+            {
+                p = broadcast<T> (7.602903343e-3f);
+                p = p * x2 + (-1.659601165e-1f);
+                p = p * x2 + 9.998918213e-1f;
+            }
+            else
+            {
+                p = broadcast<T> (2.601903068e-6f);
+                p = p * x2 + (-1.980741873e-4f);
+                p = p * x2 + 8.333025139e-3f;
+                p = p * x2 + (-1.666665668e-1f);
+                p = p * x2 + 9.999999947e-1f;
+            }
+
+            return p * x;
+        }
+    }
+
+    //==============================================================================
+    /** sin (2 * pi * phase) for a normalised phase in [0, 1). */
+    template <Accuracy accuracy, typename T>
+    inline T sin2Pi (T phase) noexcept
+    {
+        using namespace detail;
+
+        // Fold into [-1/4, 1/4], where sine is monotonic
+        const auto w = broadcast<T> (0.5f) - phase;
+        const auto folded = maximum (minimum (w, broadcast<T> (0.5f) - w), broadcast<T> (-0.5f) - w);
+        return sinHalfPi<accuracy> (folded * juce::MathConstants<float>::twoPi);
+    }
+
+    /** tan (x) for x in [0, pi/2), as sin (x) / cos (x) with both taken from
+        the same polynomial, so the relative error stays bounded towards pi/2.
+    */
+    template <Accuracy accuracy>
+    inline float tan (float x) noexcept
+    {
+        // pi/2 in float is 4.4e-8 too large, which near pi/2 would dominate
+        // the error of the cosine, so the difference is added back
+        const auto complement = (juce::MathConstants<float>::halfPi - x) - 4.371139e-8f;
+        return detail::sinHalfPi<accuracy> (x) / detail::sinHalfPi<accuracy> (complement);
+    }
+
+    /** 2 to the power of x, clamped to the range of normal floats. */
+    template <Accuracy accuracy>
+    inline float exp2 (float x) noexcept
+    {
+        x = juce::jlimit (-126.0f, 127.0f, x);
+
+        const auto whole = std::floor (x);
+        const auto f = x - whole;
+        float p;
+
+        if constexpr (accuracy == Accuracy::draft)
+        {
+            p = 7.802452266e-2f;
+            p = p * f + 2.260671554e-1f;
+            p = p * f + 6.958335405e-1f;
+            p = p * f + 9.999252186e-1f;
+        }
+        else
+        {
+            p = 1.877576673e-3f;
+            p = p * f + 8.989340095e-3f;
+            p = p * f + 5.582631805e-2f;
+            p = p * f + 2.401536170e-1f;
+            p = p * f + 6.931530732e-1f;
+            p = p * f + 9.999999251e-1f;
+        }
+
+        // The whole part goes straight into the exponent bits
+        const auto bits = static_cast<juce::uint32> (static_cast<int> (whole) + 127) << 23;
+        float scale;
+        std::memcpy (&scale, &bits, sizeof (scale));
+        return p * scale;
+    }
+
+    /** e to the power of x. */
+    template <Accuracy accuracy>
+    inline float exp (float x) noexcept
+    {
+        return exp2<accuracy> (x * 1.442695041f);
+    }
+
+    //==============================================================================
+    /** The same, with the tier picked at run time. */
+    inline float sin2Pi (Accuracy accuracy, float phase) noexcept
+    {
+        return accuracy == Accuracy::draft ? sin2Pi<Accuracy::draft> (phase) : sin2Pi<Accuracy::exact> (phase);
+    }
+
+    inline float tan (Accuracy accuracy, float x) noexcept
+    {
+        return accuracy == Accuracy::draft ? tan<Accuracy::draft> (x) : tan<Accuracy::exact> (x);
+    }
+
+    inline float exp2 (Accuracy accuracy, float x) noexcept
+    {
+        return accuracy == Accuracy::draft ? exp2<Accuracy::draft> (x) : exp2<Accuracy::exact> (x);
+    }
+
+    inline float exp (Accuracy accuracy, float x) noexcept
+    {
+        return accuracy == Accuracy::draft ? exp<Accuracy::draft> (x) : exp<Accuracy::exact> (x);
+    }
+}
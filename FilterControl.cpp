@@ -0,0 +1,82 @@
+#include "FilterControl.h"
+
+//==============================================================================
+void FilterControl::prepare (double newSampleRate, int newControlInterval)
+{
+    sampleRate = newSampleRate;
+    controlInterval = juce::jmax (1, newControlInterval);
+    radiansPerHertz = static_cast<float> (juce::MathConstants<double>::pi / sampleRate);
+    maxFrequency = static_cast<float> (0.49 * sampleRate);
+
+    // Smoothing advances once per control step, not once per sample
+    const auto controlRate = sampleRate / controlInterval;
+    cutoff.reset (controlRate, 0.02);
+    resonance.reset (controlRate, 0.02);
+
+    needsReset = true;
+}
+
+float FilterControl::getG (float frequency) const
+{
+    // g = tan (pi * fc / fs), kept below Nyquist for low sample rates
+    const auto limited = juce::jmin (juce::jlimit (minCutoff, maxCutoff, frequency), maxFrequency);
+    return FastMath::tan (accuracy, limited * radiansPerHertz);
+}
+
+FilterCoefficients FilterControl::calculate (float frequency, float q) const
+{
+    FilterCoefficients c;
+    c.g = getG (frequency);
+
+    const auto R2 = 1.0f / q;
+    c.gR2 = c.g + R2;
+    c.h = 1.0f / (1.0f + R2 * c.g + c.g * c.g);
+    return c;
+}
+
+void FilterControl::reset (float newCutoff, float newResonance)
+{
+    cutoff.setCurrentAndTargetValue (newCutoff);
+    resonance.setCurrentAndTargetValue (newResonance);
+
+    lastCutoff = newCutoff;
+    lastResonance = newResonance;
+    latest = calculate (newCutoff, newResonance);
+    needsReset = false;
+}
+
+void FilterControl::setTargets (float newCutoff, float newResonance)
+{
+    if (needsReset)
+    {
+        reset (newCutoff, newResonance);
+        return;
+    }
+
+    cutoff.setTargetValue (newCutoff);
+    resonance.setTargetValue (newResonance);
+}
+
+FilterCoefficients FilterControl::getNextControlStep (FilterCoefficients& increment)
+{
+    const auto start = latest;
+
+    const auto smoothedCutoff = cutoff.getNextValue();
+    const auto smoothedResonance = resonance.getNextValue();
+
+    // Cached coefficients are reused until the smoothed values move
+    if (! juce::approximatelyEqual (smoothedCutoff, lastCutoff)
+         || ! juce::approximatelyEqual (smoothedResonance, lastResonance))
+    {
+        latest = calculate (smoothedCutoff, smoothedResonance);
+        lastCutoff = smoothedCutoff;
+        lastResonance = smoothedResonance;
+    }
+
+    const auto scale = 1.0f / static_cast<float> (controlInterval);
+    increment.g = (latest.g - start.g) * scale;
+    increment.gR2 = (latest.gR2 - start.gR2) * scale;
+    increment.h = (latest.h - start.h) * scale;
+
+    return start;
+}
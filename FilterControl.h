@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "FastMath.h"
+
+//==============================================================================
+/** Coefficients of the TPT state variable filter, in the same form as
+    juce::dsp::StateVariableTPTFilter uses them. gR2 is g + R2, which is what
+    the filter equations actually need.
+*/
+struct FilterCoefficients
+{
+    float g = 0.0f;
+    float gR2 = 1.0f;
+    float h = 1.0f;
+
+    bool operator== (const FilterCoefficients& other) const noexcept    { return g == other.g && gR2 == other.gR2 && h == other.h; }
+    bool operator!= (const FilterCoefficients& other) const noexcept    { return ! operator== (other); }
+};
+
+//==============================================================================
+/** Produces filter coefficients at control rate rather than per sample.
+
+    Cutoff and resonance are smoothed once per control interval and the
+    coefficients are only recomputed when the smoothed values actually move,
+    with tan() taken from FastMath at the chosen accuracy. Between two control
+    points the kernel ramps the coefficients linearly.
+*/
+class FilterControl
+{
+public:
+    static constexpr int defaultControlInterval = 32;
+
+    void prepare (double sampleRate, int controlInterval);
+
+    /** Picks the tan() used for new coefficients. */
+    void setAccuracy (FastMath::Accuracy newAccuracy) noexcept     { accuracy = newAccuracy; }
+
+    /** Jumps straight to the given settings, e.g. when the first block starts. */
+    void reset (float cutoff, float resonance);
+
+    /** Sets where the smoothed values should head to, called once per block. */
+    void setTargets (float cutoff, float resonance);
+
+    /** Makes the next setTargets() jump there, like reset(). */
+    void jumpToNextTargets() noexcept   { needsReset = true; }
+
+    /** Advances one control step. Returns the coefficients at the start of the
+        step and fills increment with the per-sample change across it.
+    */
+    FilterCoefficients getNextControlStep (FilterCoefficients& increment);
+
+    /** The smoothed settings the last step heads to. */
+    float getCutoff() const noexcept        { return lastCutoff; }
+    float getResonance() const noexcept     { return lastResonance; }
+
+    /** Coefficients for any other settings, e.g. a voice's own modulated
+        cutoff, with the same tan() and limits. Cutoff is clamped, resonance is
+        taken as it is.
+    */
+    FilterCoefficients calculate (float cutoff, float resonance) const;
+
+    int getControlInterval() const      { return controlInterval; }
+
+    static constexpr float minCutoff = 20.0f;
+    static constexpr float maxCutoff = 20000.0f;
+    static constexpr float minResonance = 0.01f;    // resonance is the filter's Q
+    static constexpr float maxResonance = 1.0f;
+
+private:
+    float getG (float cutoff) const;
+
+    double sampleRate = 44100.0;
+    int controlInterval = defaultControlInterval;
+    FastMath::Accuracy accuracy = FastMath::Accuracy::exact;
+
+    float radiansPerHertz = 0.0f;
+    float maxFrequency = 20000.0f;
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> cutoff { 500.0f };
+    juce::SmoothedValue<float> resonance { 1.0f };
+
+    FilterCoefficients latest;
+    float lastCutoff = -1.0f, lastResonance = -1.0f;
+    bool needsReset = true;
+};
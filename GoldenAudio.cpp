@@ -0,0 +1,503 @@
+#include "OfflineRenderer.h"
+
+#include <iostream>
+#include <limits>
+
+//==============================================================================
+/** Golden audio regression check.
+
+    Renders a fixed corpus of patches and note sequences through the processor
+    and compares each against the reference renders checked in under golden/:
+    the largest sample difference, the log spectral distance, and the render
+    time. Exits with 1 if any item is off by more than the tolerances, so it
+    can gate changes that are meant to leave the sound alone. ctest runs it.
+
+    The references are for one pinned configuration: offline renders at a
+    fixed rate and block size, which use exact math and render every voice on
+    one thread. The scalar and SIMD kernels give identical output, so only
+    compiler differences remain, which the default tolerances allow for.
+
+    Render times can't be compared across machines directly, so each machine
+    also times a fixed calibration workload that doesn't involve the synth.
+    Items are compared by their time as a multiple of that.
+
+    After a change that is meant to alter the sound, or the render time, run
+    with --record to write new references, and commit them.
+*/
+namespace
+{
+    constexpr double goldenSampleRate = 48000.0;
+    constexpr int goldenBlockSize = 256;
+    constexpr double goldenTailSeconds = 0.5;
+
+    struct Tolerances
+    {
+        double maxError = 1.0e-3;       // absolute, on any sample
+        double maxSpectral = 0.5;       // dB
+        double maxSlowdown = 0.5;       // increase in calibrated render time, as a fraction of the reference
+        bool checkTiming = true;
+    };
+
+    //==============================================================================
+    struct CorpusItem
+    {
+        juce::String name;
+        juce::StringArray parameters;
+        juce::MidiMessageSequence notes;
+    };
+
+    void addNote (juce::MidiMessageSequence& sequence, double start, double length, int note, float velocity)
+    {
+        sequence.addEvent (juce::MidiMessage::noteOn (1, note, velocity), start);
+        sequence.addEvent (juce::MidiMessage::noteOff (1, note), start + length);
+    }
+
+    /** Each item exercises a different part of the voice: shapes, filter types,
+        the LFO, unison and pan, envelope corners, and voice stealing.
+    */
+    std::vector<CorpusItem> createCorpus()
+    {
+        std::vector<CorpusItem> corpus;
+
+        {
+            CorpusItem item { "init-sine", {}, {} };
+            addNote (item.notes, 0.0, 1.0, 69, 0.8f);
+            corpus.push_back (std::move (item));
+        }
+
+        {
+            CorpusItem item { "saw-chord-lowpass",
+                              { "OSC1_WAVE=Saw", "OSC2_WAVE=Saw", "OSC_MIX=0.3", "FILTER_CUTOFF=1200", "FILTER_RESONANCE=0.6",
+                                "ATTACK=0.01", "RELEASE=0.3" },
+                              {} };
+
+            for (auto note : { 48, 52, 55, 59 })
+                addNote (item.notes, 0.0, 1.5, note, 0.7f);
+
+            corpus.push_back (std::move (item));
+        }
+
+        {
+            CorpusItem item { "square-bandpass-lfo",
+                              { "OSC1_WAVE=Square", "OSC2_WAVE=Triangle", "FILTER_TYPE=Bandpass", "FILTER_CUTOFF=900",
+                                "FILTER_RESONANCE=0.4", "LFO_RATE=5", "LFO_DEPTH=0.6", "LFO_STEREO_PHASE=90" },
+                              {} };
+
+            for (int step = 0; step < 8; ++step)
+                addNote (item.notes, 0.2 * step, 0.18, 60 + (step * 7) % 12, 0.5f + 0.05f * (float) step);
+
+            corpus.push_back (std::move (item));
+        }
+
+        {
+            CorpusItem item { "supersaw-highpass",
+                              { "OSC1_WAVE=Saw", "OSC2_WAVE=Saw", "UNISON_VOICES=7", "UNISON_DETUNE=30", "UNISON_WIDTH=1",
+                                "PAN_SPREAD=0.8", "FILTER_TYPE=Highpass", "FILTER_CUTOFF=200" },
+                              {} };
+
+            for (auto note : { 36, 43, 48, 52, 55, 60, 64, 67 })
+                addNote (item.notes, 0.0, 1.2, note, 0.6f);
+
+            corpus.push_back (std::move (item));
+        }
+
+        {
+            CorpusItem item { "staccato-envelopes",
+                              { "OSC1_WAVE=Triangle", "OSC2_WAVE=Sine", "ATTACK=0", "DECAY=0.05", "SUSTAIN=0", "RELEASE=0.02" },
+                              {} };
+
+            for (int step = 0; step < 32; ++step)
+                addNote (item.notes, 0.03 * step, 0.01 + 0.002 * step, 72 - step % 5, 1.0f);
+
+            corpus.push_back (std::move (item));
+        }
+
+        {
+            // More overlapping notes than there are voices
+            CorpusItem item { "voice-stealing",
+                              { "OSC1_WAVE=Saw", "OSC2_WAVE=Square", "ATTACK=0.05", "RELEASE=1" },
+                              {} };
+
+            for (int step = 0; step < 24; ++step)
+                addNote (item.notes, 0.05 * step, 1.0, 40 + step * 2, 0.9f);
+
+            corpus.push_back (std::move (item));
+        }
+
+        {
+            // Every kind of source and destination the matrix has
+            CorpusItem item { "modulation-matrix",
+                              { "OSC1_WAVE=Saw", "OSC2_WAVE=Square", "FILTER_CUTOFF=800", "FILTER_RESONANCE=0.5",
+                                "LFO_WAVE=Triangle", "LFO_RATE=3", "LFO2_WAVE=Sine", "LFO2_RATE=0.7",
+                                "MOD1_SOURCE=LFO 2", "MOD1_DESTINATION=Pitch", "MOD1_DEPTH=0.05",
+                                "MOD2_SOURCE=Envelope", "MOD2_DESTINATION=Cutoff", "MOD2_DEPTH=0.6",
+                                "MOD3_SOURCE=Velocity", "MOD3_DESTINATION=Mix", "MOD3_DEPTH=0.5",
+                                "MOD4_SOURCE=LFO 1", "MOD4_DESTINATION=Resonance", "MOD4_DEPTH=0.3" },
+                              {} };
+
+            for (int step = 0; step < 6; ++step)
+                addNote (item.notes, 0.25 * step, 0.5, 48 + step * 5, 0.3f + 0.12f * (float) step);
+
+            corpus.push_back (std::move (item));
+        }
+
+        for (auto& item : corpus)
+            item.notes.updateMatchedPairs();
+
+        return corpus;
+    }
+
+    //==============================================================================
+    /** Renders an item on a renderer of its own, so the audio is that of a
+        first render which nothing else ran before. Further renders only time
+        it, and the fastest time counts.
+    */
+    RenderResult renderItem (const CorpusItem& item, int repeats, juce::AudioBuffer<float>& audio)
+    {
+        RenderJob job;
+        job.sampleRate = goldenSampleRate;
+        job.blockSize = goldenBlockSize;
+        job.tailSeconds = goldenTailSeconds;
+        job.midiSequence = item.notes;
+        job.parameters = item.parameters;
+
+        OfflineRenderer renderer;
+        auto best = renderer.render (job);
+
+        if (! best.succeeded)
+            return best;
+
+        audio.makeCopyOf (renderer.getOutput());
+
+        for (int i = 1; i < repeats; ++i)
+        {
+            const auto result = renderer.render (job);
+            best.renderSeconds = juce::jmin (best.renderSeconds, result.renderSeconds);
+        }
+
+        return best;
+    }
+
+    /** The fastest of a few runs of a workload that stands in for the speed of
+        the machine: a resonant filter fed by a sine, one sample after the
+        other, the kind of arithmetic a voice does.
+    */
+    double timeCalibration (int repeats)
+    {
+        constexpr int numSamples = 1 << 21;
+        auto best = std::numeric_limits<double>::max();
+        volatile float sink = 0.0f;
+
+        for (int run = 0; run < juce::jmax (3, repeats); ++run)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            float s1 = 0.0f, s2 = 0.0f, phase = 0.0f;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto input = std::sin (phase);
+                phase = phase + 0.01f > juce::MathConstants<float>::twoPi ? 0.0f : phase + 0.01f;
+
+                const auto output = 0.02f * input + 1.9f * s1 - 0.95f * s2;
+                s2 = s1;
+                s1 = output;
+            }
+
+            best = juce::jmin (best, juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+            sink = s1;
+        }
+
+        juce::ignoreUnused (sink);
+        return best;
+    }
+
+    juce::Result writeReference (const juce::File& file, const juce::AudioBuffer<float>& audio)
+    {
+        auto stream = std::make_unique<juce::FileOutputStream> (file);
+
+        if (! stream->openedOk())
+            return juce::Result::fail ("Couldn't open " + file.getFullPathName());
+
+        stream->setPosition (0);
+        stream->truncate();
+
+        // 32 bit WAVs hold floats, so the reference is exactly what was rendered
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), goldenSampleRate,
+                                                                              static_cast<unsigned int> (audio.getNumChannels()),
+                                                                              32, {}, 0));
+
+        if (writer == nullptr)
+            return juce::Result::fail ("Couldn't create a WAV writer for " + file.getFullPathName());
+
+        stream.release();
+
+        if (! writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples()))
+            return juce::Result::fail ("Couldn't write " + file.getFullPathName());
+
+        return juce::Result::ok();
+    }
+
+    juce::Result readReference (const juce::File& file, juce::AudioBuffer<float>& audio)
+    {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader (wav.createReaderFor (new juce::FileInputStream (file), true));
+
+        if (reader == nullptr)
+            return juce::Result::fail ("Couldn't read " + file.getFullPathName() + ", record the references first");
+
+        audio.setSize (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+        reader->read (&audio, 0, audio.getNumSamples(), 0, true, true);
+        return juce::Result::ok();
+    }
+
+    //==============================================================================
+    double getMaxError (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        double maxError = 0.0;
+
+        for (int channel = 0; channel < a.getNumChannels(); ++channel)
+        {
+            const auto* x = a.getReadPointer (channel);
+            const auto* y = b.getReadPointer (channel);
+
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                maxError = juce::jmax (maxError, (double) std::abs (x[i] - y[i]));
+        }
+
+        return maxError;
+    }
+
+    /** RMS difference of the two log magnitude spectra, in dB, averaged over
+        half-overlapping Hann windowed frames. Levels are floored at -120 dB,
+        so differences buried in silence don't count.
+    */
+    double getSpectralDistance (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        constexpr int order = 11;
+        constexpr int size = 1 << order;
+        constexpr int numBins = size / 2;
+
+        juce::dsp::FFT fft (order);
+        juce::dsp::WindowingFunction<float> window ((size_t) size, juce::dsp::WindowingFunction<float>::hann, false);
+        std::vector<float> frameA ((size_t) size * 2), frameB ((size_t) size * 2);
+
+        auto toDecibels = [] (float magnitude)
+        {
+            return juce::Decibels::gainToDecibels (magnitude * (4.0f / size), -120.0f);
+        };
+
+        double sum = 0.0;
+        int numFrames = 0;
+
+        for (int channel = 0; channel < a.getNumChannels(); ++channel)
+        {
+            for (int start = 0; start + size <= a.getNumSamples(); start += size / 2)
+            {
+                std::fill (frameA.begin(), frameA.end(), 0.0f);
+                std::fill (frameB.begin(), frameB.end(), 0.0f);
+                std::copy_n (a.getReadPointer (channel, start), size, frameA.begin());
+                std::copy_n (b.getReadPointer (channel, start), size, frameB.begin());
+
+                window.multiplyWithWindowingTable (frameA.data(), (size_t) size);
+                window.multiplyWithWindowingTable (frameB.data(), (size_t) size);
+                fft.performFrequencyOnlyForwardTransform (frameA.data(), true);
+                fft.performFrequencyOnlyForwardTransform (frameB.data(), true);
+
+                double frameSum = 0.0;
+
+                for (int bin = 0; bin < numBins; ++bin)
+                {
+                    const auto difference = toDecibels (frameA[(size_t) bin]) - toDecibels (frameB[(size_t) bin]);
+                    frameSum += difference * difference;
+                }
+
+                sum += std::sqrt (frameSum / numBins);
+                ++numFrames;
+            }
+        }
+
+        return numFrames > 0 ? sum / numFrames : 0.0;
+    }
+
+    //==============================================================================
+    juce::File getTimingsFile (const juce::File& directory)
+    {
+        return directory.getChildFile ("timings.json");
+    }
+
+    int record (const std::vector<CorpusItem>& corpus, const juce::File& directory, int repeats)
+    {
+        if (auto created = directory.createDirectory(); created.failed())
+        {
+            std::cerr << "Error: " << created.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        auto* timings = new juce::DynamicObject();
+        juce::AudioBuffer<float> audio;
+
+        for (auto& item : corpus)
+        {
+            const auto result = renderItem (item, repeats, audio);
+            auto outcome = result.succeeded ? writeReference (directory.getChildFile (item.name + ".wav"), audio)
+                                            : juce::Result::fail (result.error);
+
+            if (outcome.failed())
+            {
+                std::cerr << "Error: " << item.name << ": " << outcome.getErrorMessage() << std::endl;
+                return 1;
+            }
+
+            timings->setProperty (item.name, result.renderSeconds);
+            std::cout << item.name << ": " << juce::String (result.audioSeconds, 2) << " s audio in "
+                      << juce::String (result.renderSeconds, 4) << " s" << std::endl;
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty ("calibrationSeconds", timeCalibration (repeats));
+        root->setProperty ("renderSeconds", juce::var (timings));
+
+        if (! getTimingsFile (directory).replaceWithText (juce::JSON::toString (juce::var (root))))
+        {
+            std::cerr << "Error: couldn't write " << getTimingsFile (directory).getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << "Recorded " << corpus.size() << " references in " << directory.getFullPathName() << std::endl;
+        return 0;
+    }
+
+    int compare (const std::vector<CorpusItem>& corpus, const juce::File& directory, int repeats, Tolerances tolerances)
+    {
+        if (! getTimingsFile (directory).existsAsFile())
+        {
+            std::cerr << "Error: no references in " << directory.getFullPathName()
+                      << ", record them with --record and commit them" << std::endl;
+            return 1;
+        }
+
+        const auto timings = juce::JSON::parse (getTimingsFile (directory));
+        const auto referenceCalibration = (double) timings["calibrationSeconds"];
+        const auto calibration = tolerances.checkTiming ? timeCalibration (repeats) : 0.0;
+
+        if (tolerances.checkTiming && referenceCalibration <= 0.0)
+        {
+            tolerances.checkTiming = false;
+            std::cout << "Note: the references have no calibration time, render times are only reported\n\n";
+        }
+
+        juce::AudioBuffer<float> output, reference;
+        int numFailed = 0;
+
+        for (auto& item : corpus)
+        {
+            std::cout << item.name.paddedRight (' ', 22);
+
+            const auto result = renderItem (item, repeats, output);
+            auto outcome = result.succeeded ? readReference (directory.getChildFile (item.name + ".wav"), reference)
+                                            : juce::Result::fail (result.error);
+
+            if (outcome.wasOk() && (reference.getNumChannels() != output.getNumChannels()
+                                     || reference.getNumSamples() != output.getNumSamples()))
+                outcome = juce::Result::fail ("length or channel count differs from the reference");
+
+            if (outcome.failed())
+            {
+                std::cout << "FAILED, " << outcome.getErrorMessage() << "\n";
+                ++numFailed;
+                continue;
+            }
+
+            const auto maxError = getMaxError (output, reference);
+            const auto spectral = getSpectralDistance (output, reference);
+            const auto referenceSeconds = (double) timings["renderSeconds"][juce::Identifier (item.name)];
+            // Both times as a multiple of their machine's calibration time
+            const auto slowdown = referenceSeconds > 0.0 && tolerances.checkTiming
+                                      ? (result.renderSeconds / calibration) / (referenceSeconds / referenceCalibration) - 1.0
+                                      : 0.0;
+
+            juce::StringArray problems;
+
+            if (maxError > tolerances.maxError)
+                problems.add ("max error");
+
+            if (spectral > tolerances.maxSpectral)
+                problems.add ("spectral distance");
+
+            if (tolerances.checkTiming && slowdown > tolerances.maxSlowdown)
+                problems.add ("render time");
+
+            std::cout << (problems.isEmpty() ? "ok      " : "FAILED  ")
+                      << "max error " << juce::String (maxError, 3, true)
+                      << "  spectral " << juce::String (spectral, 3) << " dB"
+                      << "  " << juce::String (result.getRealtimeFactor(), 1) << "x realtime"
+                      << (slowdown >= 0.0 ? " (+" : " (") << juce::String (slowdown * 100.0, 1) << "% time)";
+
+            if (! problems.isEmpty())
+            {
+                std::cout << ", over the limit for " << problems.joinIntoString (", ");
+                ++numFailed;
+            }
+
+            std::cout << "\n";
+        }
+
+        std::cout << "\n" << corpus.size() - (size_t) numFailed << " of " << corpus.size() << " passed" << std::endl;
+        return numFailed == 0 ? 0 : 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << "Renders a fixed corpus through JuceNeutron and compares it with reference renders.\n\n"
+                     "Usage: JuceNeutronGolden [options]              compare with the references\n"
+                     "       JuceNeutronGolden --record [options]     (re)write the references\n\n"
+                     "  --dir=<folder>        where the references live (default golden)\n"
+                     "  --only=<name,...>     corpus items to run (default all)\n"
+                     "  --repeats=<n>         renders per item, the fastest time counts (default 3)\n"
+                     "  --max-error=<x>       largest allowed difference of any sample (default 1e-3)\n"
+                     "  --max-spectral=<dB>   largest allowed log spectral distance (default 0.5)\n"
+                     "  --max-slowdown=<x>    allowed increase in calibrated render time, 0.5 is 50% (default 0.5)\n"
+                     "  --no-timing           don't fail on render time\n\n"
+                     "Exits with 1 if any item fails.\n";
+        return 0;
+    }
+
+    // The processor's parameter tree needs a message manager, but nothing here
+    // opens a window, so this runs fine without a display
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto corpus = createCorpus();
+
+    if (args.containsOption ("--only"))
+    {
+        const auto names = juce::StringArray::fromTokens (args.getValueForOption ("--only"), ",", {});
+        corpus.erase (std::remove_if (corpus.begin(), corpus.end(), [&] (const CorpusItem& item) { return ! names.contains (item.name); }),
+                      corpus.end());
+    }
+
+    const auto directory = juce::File::getCurrentWorkingDirectory()
+                               .getChildFile (args.containsOption ("--dir") ? args.getValueForOption ("--dir").unquoted() : "golden");
+    const auto repeats = args.containsOption ("--repeats") ? juce::jmax (1, args.getValueForOption ("--repeats").getIntValue()) : 3;
+
+    if (args.containsOption ("--record"))
+        return record (corpus, directory, repeats);
+
+    Tolerances tolerances;
+    tolerances.checkTiming = ! args.containsOption ("--no-timing");
+
+    for (auto [option, value] : { std::pair { "--max-error",    &tolerances.maxError },
+                                  std::pair { "--max-spectral", &tolerances.maxSpectral },
+                                  std::pair { "--max-slowdown", &tolerances.maxSlowdown } })
+        if (args.containsOption (option))
+            *value = args.getValueForOption (option).getDoubleValue();
+
+    return compare (corpus, directory, repeats, tolerances);
+}
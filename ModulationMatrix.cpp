@@ -0,0 +1,79 @@
+#include "ModulationMatrix.h"
+
+//==============================================================================
+float ModulationMatrix::getRange (Destination destination) noexcept
+{
+    switch (destination)
+    {
+        case Destination::pitch:        return 12.0f;
+        case Destination::mix:          return 1.0f;
+        case Destination::cutoff:       return 4.0f;
+        case Destination::resonance:    return 1.0f;
+    }
+
+    return 0.0f;
+}
+
+float ModulationMatrix::getLfoSample (LfoWave wave, float phase, FastMath::Accuracy accuracy) noexcept
+{
+    // The same shapes the oscillators had before they went band-limited
+    switch (wave)
+    {
+        case LfoWave::saw:          return 2.0f * phase - 1.0f;
+        case LfoWave::square:       return phase < 0.5f ? 1.0f : -1.0f;
+        case LfoWave::triangle:     return 4.0f * std::abs (phase - 0.5f) - 1.0f;
+        case LfoWave::sine:
+        default:                    return FastMath::sin2Pi (accuracy, phase);
+    }
+}
+
+//==============================================================================
+void ModulationMatrix::setRoutes (const Routes& newRoutes) noexcept
+{
+    routes = newRoutes;
+    usedSources = 0;
+    usedDestinations = 0;
+
+    for (const auto& route : routes)
+    {
+        if (route.source == Source::none)
+            continue;
+
+        usedSources |= 1u << (int) route.source;
+        usedDestinations |= 1u << (int) route.destination;
+    }
+
+    // Destinations nobody writes any more read as unmodulated
+    for (auto& destination : amounts)
+        std::fill (std::begin (destination), std::end (destination), 0.0f);
+}
+
+void ModulationMatrix::setSource (Source source, float value) noexcept
+{
+    juce::FloatVectorOperations::fill (sources[(size_t) source], value, numLanes);
+}
+
+void ModulationMatrix::setSource (Source source, const float* values) noexcept
+{
+    juce::FloatVectorOperations::copy (sources[(size_t) source], values, numLanes);
+}
+
+void ModulationMatrix::setSource (Source source, int lane, float value) noexcept
+{
+    sources[(size_t) source][lane] = value;
+}
+
+void ModulationMatrix::evaluate() noexcept
+{
+    if (usedDestinations == 0)
+        return;
+
+    for (int destination = 0; destination < numDestinations; ++destination)
+        if ((usedDestinations & (1u << destination)) != 0)
+            juce::FloatVectorOperations::clear (amounts[destination], numLanes);
+
+    for (const auto& route : routes)
+        if (route.source != Source::none)
+            juce::FloatVectorOperations::addWithMultiply (amounts[(size_t) route.destination], sources[(size_t) route.source],
+                                                          route.depth * getRange (route.destination), numLanes);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "FastMath.h"
+#include "VoiceKernel.h"
+
+//==============================================================================
+/** Routes modulation sources to voice destinations, for every voice lane at
+    once.
+
+    Sources are written as one value per lane, the LFOs filled across all of
+    them, and evaluate() sums every route's source times its depth into one
+    contiguous buffer per destination. This runs once per control tick, so the
+    sources are never evaluated per sample; the voice pool ramps the results
+    per sample only for the destinations that would step audibly otherwise.
+*/
+class ModulationMatrix
+{
+public:
+    static constexpr int numLanes = VoiceLanes::numLanes;
+    static constexpr int maxRoutes = 4;
+
+    enum class Source
+    {
+        none,
+        lfo1,           // -1 to 1
+        lfo2,
+        envelope,       // the voice's own envelope level, 0 to 1
+        velocity        // of the voice's note, 0 to 1
+    };
+
+    enum class Destination
+    {
+        pitch,          // semitones
+        mix,            // added to the oscillator mix, 0 = oscillator 1 only
+        cutoff,         // octaves
+        resonance       // added to the resonance parameter
+    };
+
+    static constexpr int numSources = 5;
+    static constexpr int numDestinations = 4;
+
+    enum class LfoWave
+    {
+        sine,
+        saw,
+        square,
+        triangle
+    };
+
+    struct Route
+    {
+        Source source = Source::none;
+        Destination destination = Destination::cutoff;
+        float depth = 0.0f;         // -1 to 1, of the destination's range
+
+        bool operator== (const Route& other) const noexcept
+        {
+            return source == other.source && destination == other.destination && depth == other.depth;
+        }
+
+        bool operator!= (const Route& other) const noexcept    { return ! operator== (other); }
+    };
+
+    using Routes = std::array<Route, (size_t) maxRoutes>;
+
+    /** How far a depth of 1 moves each destination. */
+    static float getRange (Destination destination) noexcept;
+
+    /** One LFO value, -1 to 1, for a normalised phase in [0, 1). */
+    static float getLfoSample (LfoWave wave, float phase, FastMath::Accuracy accuracy) noexcept;
+
+    //==============================================================================
+    void setRoutes (const Routes& newRoutes) noexcept;
+
+    /** True if any route reads the source, or writes the destination, with
+        whatever depth.
+    */
+    bool uses (Source source) const noexcept                 { return (usedSources & (1u << (int) source)) != 0; }
+    bool modulates (Destination destination) const noexcept  { return (usedDestinations & (1u << (int) destination)) != 0; }
+    bool isActive() const noexcept                           { return usedDestinations != 0; }
+
+    /** The same value in every lane, for the LFOs. */
+    void setSource (Source source, float value) noexcept;
+
+    /** One value per lane, numLanes of them. */
+    void setSource (Source source, const float* values) noexcept;
+
+    /** One lane's value, e.g. the velocity when a voice starts. */
+    void setSource (Source source, int lane, float value) noexcept;
+
+    /** Sums the routes into the destination buffers. */
+    void evaluate() noexcept;
+
+    /** The summed modulation of every lane, in the destination's units. Zero
+        for destinations that no route writes.
+    */
+    const float* getAmounts (Destination destination) const noexcept   { return amounts[(size_t) destination]; }
+    float getAmount (Destination destination, int lane) const noexcept  { return amounts[(size_t) destination][lane]; }
+
+private:
+    Routes routes {};
+    juce::uint32 usedSources = 0, usedDestinations = 0;
+
+    alignas (32) float sources[numSources][numLanes] {};
+    alignas (32) float amounts[numDestinations][numLanes] {};
+};
@@ -0,0 +1,219 @@
+#include "OfflineRenderer.h"
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer()
+    : processor (std::make_unique<AudioPluginAudioProcessor>())
+{
+}
+
+juce::Result OfflineRenderer::applyParameterFile (AudioPluginAudioProcessor& processor, const juce::File& file)
+{
+    if (! file.existsAsFile())
+        return juce::Result::fail ("Parameter file not found: " + file.getFullPathName());
+
+    juce::StringArray lines;
+    file.readLines (lines);
+
+    return applyParameters (processor, lines, file.getFileName());
+}
+
+juce::Result OfflineRenderer::applyParameters (AudioPluginAudioProcessor& processor, const juce::StringArray& lines,
+                                               const juce::String& sourceName)
+{
+    // One PARAMETER_ID=value per line, values written the way the parameter
+    // displays them (e.g. OSC1_WAVE=Saw, FILTER_CUTOFF=1200)
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const auto line = lines[i].upToFirstOccurrenceOf ("#", false, false).trim();
+
+        if (line.isEmpty())
+            continue;
+
+        const auto id = line.upToFirstOccurrenceOf ("=", false, false).trim();
+        const auto text = line.fromFirstOccurrenceOf ("=", false, false).trim();
+        auto* parameter = processor.apvts.getParameter (id);
+
+        if (parameter == nullptr || ! line.containsChar ('='))
+            return juce::Result::fail (sourceName + ":" + juce::String (i + 1) + ": can't parse \"" + line + "\"");
+
+        parameter->setValueNotifyingHost (parameter->getValueForText (text));
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::readMidiFile (const juce::File& file, juce::MidiMessageSequence& sequence)
+{
+    juce::FileInputStream stream (file);
+    juce::MidiFile midiFile;
+
+    if (! stream.openedOk() || ! midiFile.readFrom (stream))
+        return juce::Result::fail ("Couldn't read MIDI file: " + file.getFullPathName());
+
+    midiFile.convertTimestampTicksToSeconds();
+
+    sequence.clear();
+
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+        sequence.addSequence (*midiFile.getTrack (track), 0.0);
+
+    sequence.updateMatchedPairs();
+    return juce::Result::ok();
+}
+
+//==============================================================================
+RenderResult OfflineRenderer::render (const RenderJob& job)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    RenderResult result;
+    auto outcome = renderToBuffer (job, result);
+
+    if (outcome.wasOk() && job.outputFile != juce::File())
+        outcome = writeWavFile (job.outputFile, job.sampleRate, output.getNumSamples());
+
+    if (outcome.wasOk() && job.traceFile != juce::File())
+        outcome = processor->getBlockTrace().writeChromeTrace (job.traceFile);
+
+    result.succeeded = outcome.wasOk();
+    result.error = outcome.getErrorMessage();
+    result.jobSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    return result;
+}
+
+juce::Result OfflineRenderer::renderToBuffer (const RenderJob& job, RenderResult& result)
+{
+    if (job.sampleRate <= 0.0 || job.blockSize <= 0)
+        return juce::Result::fail ("Invalid sample rate or block size");
+
+    // Every job starts from the default patch and waveforms, and prepareToPlay
+    // below resets the voices and LFOs, so renders don't depend on which job
+    // this renderer ran before
+    for (auto* parameter : processor->getParameters())
+        parameter->setValueNotifyingHost (parameter->getDefaultValue());
+
+    processor->clearUserWaveform();
+
+    sequence.clear();
+
+    if (job.midiFile != juce::File() || job.midiSequence.getNumEvents() > 0)
+    {
+        if (job.midiFile == juce::File())
+            sequence = job.midiSequence;
+        else if (auto loaded = readMidiFile (job.midiFile, sequence); loaded.failed())
+            return loaded;
+
+        // "Always On" ignores MIDI, a state or parameter file can still turn it back on
+        if (auto* alwaysOn = processor->apvts.getParameter (AudioPluginAudioProcessor::MASTER_ALWAYS_ON))
+            alwaysOn->setValueNotifyingHost (0.0f);
+    }
+
+    if (job.stateFile != juce::File())
+    {
+        juce::MemoryBlock state;
+
+        if (! job.stateFile.loadFileAsData (state))
+            return juce::Result::fail ("Couldn't read state file: " + job.stateFile.getFullPathName());
+
+        processor->setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+    }
+
+    if (job.parameterFile != juce::File())
+        if (auto applied = applyParameterFile (*processor, job.parameterFile); applied.failed())
+            return applied;
+
+    if (auto applied = applyParameters (*processor, job.parameters, "parameters"); applied.failed())
+        return applied;
+
+    const auto numChannels = juce::jmax (processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+    const auto totalSamples = static_cast<int> (std::ceil ((sequence.getEndTime() + job.tailSeconds) * job.sampleRate));
+
+    output.setSize (numChannels, juce::jmax (0, totalSamples), false, false, true);
+    block.setSize (numChannels, job.doublePrecision ? 0 : job.blockSize, false, false, true);
+    doubleBlock.setSize (numChannels, job.doublePrecision ? job.blockSize : 0, false, false, true);
+    midiBlock.ensureSize (4096);
+
+    processor->setNonRealtime (true);
+    processor->setProcessingPrecision (job.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                           : juce::AudioProcessor::singlePrecision);
+    processor->setRateAndBufferSizeDetails (job.sampleRate, job.blockSize);
+    processor->prepareToPlay (job.sampleRate, job.blockSize);
+    processor->getBlockTrace().clear();
+
+    int nextEvent = 0;
+    juce::int64 renderTicks = 0;
+
+    for (int start = 0; start < output.getNumSamples(); start += job.blockSize)
+    {
+        const auto numSamples = juce::jmin (job.blockSize, output.getNumSamples() - start);
+
+        midiBlock.clear();
+
+        for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+        {
+            const auto& message = sequence.getEventPointer (nextEvent)->message;
+            const auto position = juce::roundToInt (message.getTimeStamp() * job.sampleRate) - start;
+
+            if (position >= numSamples)
+                break;
+
+            if (! message.isMetaEvent())
+                midiBlock.addEvent (message, juce::jmax (0, position));
+        }
+
+        if (job.doublePrecision)
+        {
+            juce::AudioBuffer<double> view (doubleBlock.getArrayOfWritePointers(), numChannels, numSamples);
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            processor->processBlock (view, midiBlock);
+            renderTicks += juce::Time::getHighResolutionTicks() - startTicks;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                std::copy_n (view.getReadPointer (channel), numSamples, output.getWritePointer (channel, start));
+        }
+        else
+        {
+            juce::AudioBuffer<float> view (block.getArrayOfWritePointers(), numChannels, numSamples);
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            processor->processBlock (view, midiBlock);
+            renderTicks += juce::Time::getHighResolutionTicks() - startTicks;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                output.copyFrom (channel, start, view, channel, 0, numSamples);
+        }
+    }
+
+    processor->releaseResources();
+
+    result.audioSeconds = output.getNumSamples() / job.sampleRate;
+    result.renderSeconds = juce::Time::highResolutionTicksToSeconds (renderTicks);
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::writeWavFile (const juce::File& file, double sampleRate, int numSamples)
+{
+    auto stream = std::make_unique<juce::FileOutputStream> (file);
+
+    if (! stream->openedOk())
+        return juce::Result::fail ("Couldn't open output file: " + file.getFullPathName());
+
+    stream->setPosition (0);
+    stream->truncate();
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), sampleRate,
+                                                                          static_cast<unsigned int> (output.getNumChannels()),
+                                                                          24, {}, 0));
+
+    if (writer == nullptr)
+        return juce::Result::fail ("Couldn't create a WAV writer for " + file.getFullPathName());
+
+    stream.release();   // the writer owns it now
+
+    if (! writer->writeFromAudioSampleBuffer (output, 0, numSamples))
+        return juce::Result::fail ("Couldn't write " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
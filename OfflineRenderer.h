@@ -0,0 +1,74 @@
+#pragma once
+
+#include "PluginProcessor.h"
+
+//==============================================================================
+/** One offline render: a MIDI file played through a given patch into a WAV. */
+struct RenderJob
+{
+    juce::File midiFile;
+    juce::File stateFile;       // raw getStateInformation() blob, optional
+    juce::File parameterFile;   // PARAMETER_ID=value lines, optional
+    juce::File outputFile;      // optional, without one the audio is only kept in getOutput()
+    juce::File traceFile;       // Chrome trace JSON of the render's blocks, optional
+
+    // In-memory alternatives to the files, for renders generated in code
+    juce::MidiMessageSequence midiSequence;     // played when there's no midiFile, time stamps in seconds
+    juce::StringArray parameters;               // PARAMETER_ID=value lines, applied after parameterFile
+
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    double tailSeconds = 2.0;
+    bool doublePrecision = false;   // drive the double precision processBlock
+};
+
+struct RenderResult
+{
+    bool succeeded = false;
+    juce::String error;
+
+    double audioSeconds = 0.0;
+    double renderSeconds = 0.0;     // wall clock time spent in processBlock
+    double jobSeconds = 0.0;        // the whole job, including file I/O
+
+    double getRealtimeFactor() const    { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+};
+
+//==============================================================================
+/** Drives an AudioPluginAudioProcessor without a host or audio device.
+
+    The renderer owns its processor and buffers and reuses them across jobs, so
+    a worker thread can keep one renderer for its whole lifetime. Each job
+    starts from the same state, so its output doesn't depend on the renderer
+    or the jobs it ran before.
+*/
+class OfflineRenderer
+{
+public:
+    OfflineRenderer();
+
+    RenderResult render (const RenderJob& job);
+
+    AudioPluginAudioProcessor& getProcessor()   { return *processor; }
+
+    /** The audio of the last successful render. */
+    const juce::AudioBuffer<float>& getOutput() const   { return output; }
+
+    static juce::Result applyParameterFile (AudioPluginAudioProcessor& processor, const juce::File& file);
+    static juce::Result applyParameters (AudioPluginAudioProcessor& processor, const juce::StringArray& lines,
+                                         const juce::String& sourceName);
+    static juce::Result readMidiFile (const juce::File& file, juce::MidiMessageSequence& sequence);
+
+private:
+    juce::Result renderToBuffer (const RenderJob& job, RenderResult& result);
+    juce::Result writeWavFile (const juce::File& file, double sampleRate, int numSamples);
+
+    std::unique_ptr<AudioPluginAudioProcessor> processor;
+    juce::AudioBuffer<float> output;
+    juce::AudioBuffer<float> block;
+    juce::AudioBuffer<double> doubleBlock;
+    juce::MidiBuffer midiBlock;
+    juce::MidiMessageSequence sequence;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
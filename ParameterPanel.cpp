@@ -0,0 +1,130 @@
+#include "ParameterPanel.h"
+
+//==============================================================================
+struct ParameterPanel::Built
+{
+    juce::Label label;
+    std::unique_ptr<juce::Component> component;
+
+    // Declared after the component, so they're destroyed before it
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboBoxAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> buttonAttachment;
+};
+
+//==============================================================================
+ParameterPanel::ParameterPanel (const juce::String& title, juce::AudioProcessorValueTreeState& s, std::vector<Control> c)
+    : state (s), controls (std::move (c))
+{
+    setName (title);
+    setInterceptsMouseClicks (false, true);
+}
+
+ParameterPanel::~ParameterPanel() = default;
+
+void ParameterPanel::populate()
+{
+    if (isPopulated())
+        return;
+
+    built.reserve (controls.size());
+
+    // Everything is created hidden and attached first, so the attachments'
+    // initial updates don't each trigger a repaint; then the whole panel is
+    // laid out and shown at once
+    for (auto& control : controls)
+    {
+        auto item = std::make_unique<Built>();
+
+        switch (control.kind)
+        {
+            case Control::Kind::slider:
+            case Control::Kind::rotary:
+            {
+                auto slider = std::make_unique<juce::Slider>();
+
+                if (control.kind == Control::Kind::rotary)
+                {
+                    slider->setSliderStyle (juce::Slider::SliderStyle::Rotary);
+                    slider->setTextBoxStyle (juce::Slider::TextBoxBelow, true, control.textBoxWidth, 25);
+                }
+                else
+                {
+                    slider->setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
+                    slider->setTextBoxStyle (juce::Slider::TextBoxRight, true, control.textBoxWidth, 25);
+                }
+
+                item->sliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (state, control.parameterId, *slider);
+                item->component = std::move (slider);
+                break;
+            }
+
+            case Control::Kind::comboBox:
+            {
+                auto comboBox = std::make_unique<juce::ComboBox>();
+
+                if (auto* choice = dynamic_cast<juce::AudioParameterChoice*> (state.getParameter (control.parameterId)))
+                    comboBox->addItemList (choice->choices, 1);
+
+                item->comboBoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (state, control.parameterId, *comboBox);
+                item->component = std::move (comboBox);
+                break;
+            }
+
+            case Control::Kind::button:
+            {
+                auto button = std::make_unique<juce::TextButton> (control.text);
+                item->buttonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (state, control.parameterId, *button);
+                item->component = std::move (button);
+                break;
+            }
+        }
+
+        addChildComponent (*item->component);
+
+        if (control.kind != Control::Kind::button)
+        {
+            item->label.setText (control.text, juce::dontSendNotification);
+            item->label.setJustificationType (juce::Justification::centred);
+            item->label.setColour (juce::Label::textColourId, juce::Colours::white);
+            addChildComponent (item->label);
+        }
+
+        built.push_back (std::move (item));
+    }
+
+    resized();
+
+    for (size_t i = 0; i < built.size(); ++i)
+    {
+        built[i]->component->setVisible (true);
+        built[i]->label.setVisible (controls[i].kind != Control::Kind::button);
+    }
+}
+
+//==============================================================================
+void ParameterPanel::paintFrame (juce::Graphics& g) const
+{
+    const auto bounds = getBounds().toFloat();
+
+    g.setColour (juce::Colours::white.withAlpha (0.15f));
+    g.drawRoundedRectangle (bounds.reduced (0.5f), 4.0f, 1.0f);
+
+    g.setColour (juce::Colours::grey);
+    g.setFont (12.0f);
+    g.drawText (getName().toUpperCase(), bounds.withHeight ((float) titleHeight).reduced (6.0f, 0.0f),
+                juce::Justification::centredLeft);
+}
+
+void ParameterPanel::resized()
+{
+    for (size_t i = 0; i < built.size(); ++i)
+    {
+        auto area = controls[i].area;
+
+        if (controls[i].kind != Control::Kind::button)
+            built[i]->label.setBounds (area.removeFromTop (labelHeight));
+
+        built[i]->component->setBounds (area);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+//==============================================================================
+/** One titled section of the editor, holding the controls of a group of
+    parameters.
+
+    The panel starts out empty and only creates its components and their
+    attachments in populate(), all in one go, so an editor can open with just
+    the section frames and fill them in over the next few message loop turns.
+    The frame and title aren't painted by the panel itself, see paintFrame().
+*/
+class ParameterPanel final : public juce::Component
+{
+public:
+    struct Control
+    {
+        enum class Kind
+        {
+            slider,
+            rotary,
+            comboBox,
+            button
+        };
+
+        Kind kind;
+        juce::String parameterId;
+        juce::String text;
+        juce::Rectangle<int> area;      // label and control, relative to the panel
+        int textBoxWidth = 100;
+    };
+
+    ParameterPanel (const juce::String& title, juce::AudioProcessorValueTreeState& state, std::vector<Control> controls);
+    ~ParameterPanel() override;
+
+    /** Creates the components and attachments, the first time it's called. */
+    void populate();
+    bool isPopulated() const    { return ! built.empty(); }
+
+    /** Draws the panel's frame and title, in its parent's coordinates. This is
+        static background, so the editor renders it into a cached image.
+    */
+    void paintFrame (juce::Graphics&) const;
+
+    void resized() override;
+
+    static constexpr int titleHeight = 16;
+    static constexpr int labelHeight = 18;
+
+private:
+    struct Built;
+
+    juce::AudioProcessorValueTreeState& state;
+    std::vector<Control> controls;
+    std::vector<std::unique_ptr<Built>> built;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterPanel)
+};
@@ -0,0 +1,192 @@
+#include "ParameterSnapshot.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+ParameterReader::ParameterReader (juce::AudioProcessorValueTreeState& apvts)
+{
+    using Processor = AudioPluginAudioProcessor;
+
+    osc1WaveType = apvts.getRawParameterValue (Processor::OSC1_WAVE);
+    osc2WaveType = apvts.getRawParameterValue (Processor::OSC2_WAVE);
+    osc1Freq = apvts.getRawParameterValue (Processor::OSC1_FREQ);
+    osc2Freq = apvts.getRawParameterValue (Processor::OSC2_FREQ);
+    oscMix = apvts.getRawParameterValue (Processor::OSC_MIX);
+    unisonVoices = apvts.getRawParameterValue (Processor::UNISON_VOICES);
+    unisonDetune = apvts.getRawParameterValue (Processor::UNISON_DETUNE);
+    unisonWidth = apvts.getRawParameterValue (Processor::UNISON_WIDTH);
+    panSpread = apvts.getRawParameterValue (Processor::PAN_SPREAD);
+    filterType = apvts.getRawParameterValue (Processor::FILTER_TYPE);
+    filterCutoff = apvts.getRawParameterValue (Processor::FILTER_CUTOFF);
+    filterResonance = apvts.getRawParameterValue (Processor::FILTER_RESONANCE);
+    attack = apvts.getRawParameterValue (Processor::ATTACK);
+    decay = apvts.getRawParameterValue (Processor::DECAY);
+    sustain = apvts.getRawParameterValue (Processor::SUSTAIN);
+    release = apvts.getRawParameterValue (Processor::RELEASE);
+    lfoWave = apvts.getRawParameterValue (Processor::LFO_WAVE);
+    lfoRate = apvts.getRawParameterValue (Processor::LFO_RATE);
+    lfoDepth = apvts.getRawParameterValue (Processor::LFO_DEPTH);
+    lfoStereoPhase = apvts.getRawParameterValue (Processor::LFO_STEREO_PHASE);
+    lfo2Wave = apvts.getRawParameterValue (Processor::LFO2_WAVE);
+    lfo2Rate = apvts.getRawParameterValue (Processor::LFO2_RATE);
+
+    for (size_t i = 0; i < maxRoutes; ++i)
+    {
+        modSource[i] = apvts.getRawParameterValue (Processor::MOD_SOURCE[i]);
+        modDestination[i] = apvts.getRawParameterValue (Processor::MOD_DESTINATION[i]);
+        modDepth[i] = apvts.getRawParameterValue (Processor::MOD_DEPTH[i]);
+    }
+    masterEnabled = apvts.getRawParameterValue (Processor::MASTER_ENABLED);
+    masterAlwaysOn = apvts.getRawParameterValue (Processor::MASTER_ALWAYS_ON);
+}
+
+void ParameterReader::prepare (double sampleRate, int newTickInterval)
+{
+    tickInterval = juce::jmax (1, newTickInterval);
+
+    const auto tickRate = sampleRate / tickInterval;
+    osc1Smoother.reset (tickRate, smoothingSeconds);
+    osc2Smoother.reset (tickRate, smoothingSeconds);
+    mixSmoother.reset (tickRate, smoothingSeconds);
+
+    needsReset = true;
+}
+
+ParameterReader::RawValues ParameterReader::read() const noexcept
+{
+    RawValues v;
+
+    v.osc1WaveType = osc1WaveType->load();
+    v.osc2WaveType = osc2WaveType->load();
+    v.osc1Freq = osc1Freq->load();
+    v.osc2Freq = osc2Freq->load();
+    v.oscMix = oscMix->load();
+    v.unisonVoices = unisonVoices->load();
+    v.unisonDetune = unisonDetune->load();
+    v.unisonWidth = unisonWidth->load();
+    v.panSpread = panSpread->load();
+    v.filterType = filterType->load();
+    v.filterCutoff = filterCutoff->load();
+    v.filterResonance = filterResonance->load();
+    v.attack = attack->load();
+    v.decay = decay->load();
+    v.sustain = sustain->load();
+    v.release = release->load();
+    v.lfoWave = lfoWave->load();
+    v.lfoRate = lfoRate->load();
+    v.lfoDepth = lfoDepth->load();
+    v.lfoStereoPhase = lfoStereoPhase->load();
+    v.lfo2Wave = lfo2Wave->load();
+    v.lfo2Rate = lfo2Rate->load();
+
+    for (size_t i = 0; i < maxRoutes; ++i)
+    {
+        v.modSource[i] = modSource[i]->load();
+        v.modDestination[i] = modDestination[i]->load();
+        v.modDepth[i] = modDepth[i]->load();
+    }
+
+    return v;
+}
+
+const ParameterSnapshot& ParameterReader::capture (const PresetSwitch& presetSwitch)
+{
+    // A preset change may have started writing parameters while they were
+    // read, so only keep them if it hadn't begun by the time reading finished
+    const auto latest = read();
+
+    if (needsReset || ! presetSwitch.isHolding())
+        values = latest;
+
+    const auto previous = snapshot;
+    auto& s = snapshot;
+    const auto& v = values;
+
+    s.osc1WaveType = static_cast<int> (v.osc1WaveType);
+    s.osc2WaveType = static_cast<int> (v.osc2WaveType);
+    s.unisonVoices = static_cast<int> (v.unisonVoices);
+    s.unisonDetune = v.unisonDetune;
+    s.unisonWidth = v.unisonWidth;
+    s.panSpread = v.panSpread;
+    s.filterType = static_cast<int> (v.filterType);
+    s.filterCutoff = v.filterCutoff;
+    s.filterResonance = v.filterResonance;
+    s.envelope.attack = v.attack;
+    s.envelope.decay = v.decay;
+    s.envelope.sustain = v.sustain;
+    s.envelope.release = v.release;
+    s.lfoWaveType = static_cast<int> (v.lfoWave);
+    s.lfoRate = v.lfoRate;
+    s.lfoDepth = v.lfoDepth;
+    s.lfoStereoPhase = v.lfoStereoPhase;
+    s.lfo2WaveType = static_cast<int> (v.lfo2Wave);
+    s.lfo2Rate = v.lfo2Rate;
+
+    for (size_t i = 0; i < maxRoutes; ++i)
+    {
+        auto& route = s.modulationRoutes[i];
+        route.source = static_cast<ModulationMatrix::Source> (static_cast<int> (v.modSource[i]));
+        route.destination = static_cast<ModulationMatrix::Destination> (static_cast<int> (v.modDestination[i]));
+        route.depth = v.modDepth[i];
+    }
+
+    if (needsReset)
+    {
+        osc1Smoother.setCurrentAndTargetValue (v.osc1Freq);
+        osc2Smoother.setCurrentAndTargetValue (v.osc2Freq);
+        mixSmoother.setCurrentAndTargetValue (v.oscMix);
+    }
+    else
+    {
+        osc1Smoother.setTargetValue (v.osc1Freq);
+        osc2Smoother.setTargetValue (v.osc2Freq);
+        mixSmoother.setTargetValue (v.oscMix);
+    }
+
+    // Start from where the last tick ended and head for where the smoother
+    // will be at the end of this one
+    auto ramp = [this] (auto& smoother, float& value, float& step)
+    {
+        value = smoother.getCurrentValue();
+        step = smoother.isSmoothing() ? (smoother.getNextValue() - value) / (float) tickInterval : 0.0f;
+    };
+
+    ramp (osc1Smoother, s.osc1Frequency, s.osc1FrequencyStep);
+    ramp (osc2Smoother, s.osc2Frequency, s.osc2FrequencyStep);
+    ramp (mixSmoother, s.oscMix, s.oscMixStep);
+
+    if (needsReset)
+    {
+        s.changes = VoiceRenderParameters::allChanged;
+        needsReset = false;
+        return s;
+    }
+
+    s.changes = 0;
+
+    if (s.osc1WaveType != previous.osc1WaveType || s.osc2WaveType != previous.osc2WaveType)
+        s.changes |= VoiceRenderParameters::waveTypesChanged;
+
+    if (s.osc1Frequency != previous.osc1Frequency || s.osc1FrequencyStep != previous.osc1FrequencyStep
+         || s.osc2Frequency != previous.osc2Frequency || s.osc2FrequencyStep != previous.osc2FrequencyStep)
+        s.changes |= VoiceRenderParameters::tuningChanged;
+
+    if (s.unisonVoices != previous.unisonVoices || s.unisonDetune != previous.unisonDetune
+         || s.unisonWidth != previous.unisonWidth)
+        s.changes |= VoiceRenderParameters::unisonChanged;
+
+    if (s.panSpread != previous.panSpread)
+        s.changes |= VoiceRenderParameters::panChanged;
+
+    if (s.filterType != previous.filterType || s.filterCutoff != previous.filterCutoff
+         || s.filterResonance != previous.filterResonance)
+        s.changes |= VoiceRenderParameters::filterChanged;
+
+    if (s.envelope.attack != previous.envelope.attack || s.envelope.decay != previous.envelope.decay
+         || s.envelope.sustain != previous.envelope.sustain || s.envelope.release != previous.envelope.release)
+        s.changes |= VoiceRenderParameters::envelopeChanged;
+
+    if (s.modulationRoutes != previous.modulationRoutes)
+        s.changes |= VoiceRenderParameters::modulationChanged;
+
+    return s;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "ModulationMatrix.h"
+#include "PresetSwitch.h"
+#include "SynthVoice.h"
+
+//==============================================================================
+/** Every parameter the audio thread uses, read once per control tick so a tick
+    never sees half of an edit.
+
+    Frequencies and the oscillator mix are smoothed. They hold the value at the
+    start of the tick and how much it moves per sample until the next one.
+
+    What differs from the previous snapshot is flagged with the voices' own
+    VoiceRenderParameters::Changes, so the processor can pass it straight on.
+*/
+struct ParameterSnapshot
+{
+    int osc1WaveType = 0;
+    int osc2WaveType = 0;
+    float osc1Frequency = 440.0f;
+    float osc2Frequency = 440.0f;
+    float oscMix = 0.5f;
+    float osc1FrequencyStep = 0.0f;     // per sample
+    float osc2FrequencyStep = 0.0f;
+    float oscMixStep = 0.0f;
+
+    int unisonVoices = 1;
+    float unisonDetune = 0.0f;
+    float unisonWidth = 0.0f;
+
+    float panSpread = 0.0f;
+
+    int filterType = 0;
+    float filterCutoff = 500.0f;
+    float filterResonance = 0.0f;
+
+    juce::ADSR::Parameters envelope;
+
+    int lfoWaveType = 0;                // a ModulationMatrix::LfoWave
+    float lfoRate = 0.5f;
+    float lfoDepth = 0.0f;              // of LFO 1 on the cutoff, outside the modulation matrix
+    float lfoStereoPhase = 0.0f;        // degrees the right side's LFO runs ahead of the left
+    int lfo2WaveType = 0;
+    float lfo2Rate = 2.0f;
+
+    ModulationMatrix::Routes modulationRoutes {};
+
+    juce::uint32 changes = VoiceRenderParameters::allChanged;
+
+    bool hasChanged (juce::uint32 flags) const noexcept     { return (changes & flags) != 0; }
+};
+
+//==============================================================================
+/** Reads the processor's parameters into a ParameterSnapshot on the audio
+    thread, smoothing the ones that would otherwise step audibly.
+*/
+class ParameterReader
+{
+public:
+    explicit ParameterReader (juce::AudioProcessorValueTreeState& apvts);
+
+    /** The next capture starts from the current values without ramping or
+        reporting changes against old ones.
+    */
+    void prepare (double sampleRate, int tickInterval);
+
+    /** Takes the snapshot for the next tick of tickInterval samples. While the
+        preset switch is holding, the values read before it are used again.
+    */
+    const ParameterSnapshot& capture (const PresetSwitch& presetSwitch);
+
+    /** Like prepare(), the next capture takes the values as they are. */
+    void jumpToCurrentValues() noexcept         { needsReset = true; }
+
+    bool isMasterEnabled() const noexcept       { return masterEnabled->load() >= 0.5f; }
+    bool isAlwaysOn() const noexcept            { return masterAlwaysOn->load() >= 0.5f; }
+
+private:
+    std::atomic<float>* osc1WaveType = nullptr;
+    std::atomic<float>* osc2WaveType = nullptr;
+    std::atomic<float>* osc1Freq = nullptr;
+    std::atomic<float>* osc2Freq = nullptr;
+    std::atomic<float>* oscMix = nullptr;
+    std::atomic<float>* unisonVoices = nullptr;
+    std::atomic<float>* unisonDetune = nullptr;
+    std::atomic<float>* unisonWidth = nullptr;
+    std::atomic<float>* panSpread = nullptr;
+
+    std::atomic<float>* filterType = nullptr;
+    std::atomic<float>* filterCutoff = nullptr;
+    std::atomic<float>* filterResonance = nullptr;
+
+    std::atomic<float>* attack = nullptr;
+    std::atomic<float>* decay = nullptr;
+    std::atomic<float>* sustain = nullptr;
+    std::atomic<float>* release = nullptr;
+
+    std::atomic<float>* lfoWave = nullptr;
+    std::atomic<float>* lfoRate = nullptr;
+    std::atomic<float>* lfoDepth = nullptr;
+    std::atomic<float>* lfoStereoPhase = nullptr;
+    std::atomic<float>* lfo2Wave = nullptr;
+    std::atomic<float>* lfo2Rate = nullptr;
+
+    static constexpr auto maxRoutes = (size_t) ModulationMatrix::maxRoutes;
+    std::array<std::atomic<float>*, maxRoutes> modSource {}, modDestination {}, modDepth {};
+
+    std::atomic<float>* masterEnabled = nullptr;
+    std::atomic<float>* masterAlwaysOn = nullptr;
+
+    struct RawValues
+    {
+        float osc1WaveType, osc2WaveType, osc1Freq, osc2Freq, oscMix;
+        float unisonVoices, unisonDetune, unisonWidth, panSpread;
+        float filterType, filterCutoff, filterResonance;
+        float attack, decay, sustain, release;
+        float lfoWave, lfoRate, lfoDepth, lfoStereoPhase, lfo2Wave, lfo2Rate;
+        float modSource[maxRoutes], modDestination[maxRoutes], modDepth[maxRoutes];
+    };
+
+    RawValues read() const noexcept;
+
+    RawValues values {};
+
+    // Stepped once per tick, so they ramp over a fixed time at control rate
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> osc1Smoother, osc2Smoother;
+    juce::SmoothedValue<float> mixSmoother;
+
+    ParameterSnapshot snapshot;
+    int tickInterval = 1;
+    bool needsReset = true;
+
+    static constexpr double smoothingSeconds = 0.02;
+};
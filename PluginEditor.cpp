@@ -1,204 +1,305 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+namespace
+{
+    using Kind = ParameterPanel::Control::Kind;
+    using Processor = AudioPluginAudioProcessor;
+
+    // Control areas hold the label on top of the control, in panel coordinates
+    constexpr int top = ParameterPanel::titleHeight + 2;
+    constexpr int row = ParameterPanel::labelHeight + 26;
+
+    std::vector<ParameterPanel::Control> getOscillatorControls()
+    {
+        return { { Kind::comboBox, Processor::OSC1_WAVE,     "Oscillator 1 Wave",      { 5,   top,               90,  row } },
+                 { Kind::slider,   Processor::OSC1_FREQ,     "Oscillator 1 Frequency", { 100, top,               280, row }, 100 },
+                 { Kind::rotary,   Processor::OSC_MIX,       "Oscillator Mix",         { 385, top,               90,  row * 2 }, 90 },
+                 { Kind::comboBox, Processor::OSC2_WAVE,     "Oscillator 2 Wave",      { 5,   top + row + 4,     90,  row } },
+                 { Kind::slider,   Processor::OSC2_FREQ,     "Oscillator 2 Frequency", { 100, top + row + 4,     280, row }, 100 },
+                 { Kind::slider,   Processor::UNISON_VOICES, "Unison Voices",          { 5,   top + 2 * row + 8, 120, row }, 40 },
+                 { Kind::slider,   Processor::UNISON_DETUNE, "Unison Detune",          { 125, top + 2 * row + 8, 125, row }, 50 },
+                 { Kind::slider,   Processor::UNISON_WIDTH,  "Unison Width",           { 250, top + 2 * row + 8, 130, row }, 50 },
+                 { Kind::slider,   Processor::PAN_SPREAD,    "Pan Spread",             { 385, top + 2 * row + 8, 90,  row }, 40 } };
+    }
+
+    std::vector<ParameterPanel::Control> getFilterControls()
+    {
+        return { { Kind::comboBox, Processor::FILTER_TYPE,      "Filter Type",      { 5,   top, 90,  row } },
+                 { Kind::slider,   Processor::FILTER_CUTOFF,    "Filter Cutoff",    { 100, top, 190, row }, 70 },
+                 { Kind::slider,   Processor::FILTER_RESONANCE, "Filter Resonance", { 290, top, 185, row }, 60 } };
+    }
+
+    std::vector<ParameterPanel::Control> getEnvelopeControls()
+    {
+        return { { Kind::slider, Processor::ATTACK,  "Attack",  { 5,   top, 117, row }, 60 },
+                 { Kind::slider, Processor::DECAY,   "Decay",   { 122, top, 117, row }, 60 },
+                 { Kind::slider, Processor::SUSTAIN, "Sustain", { 239, top, 117, row }, 60 },
+                 { Kind::slider, Processor::RELEASE, "Release", { 356, top, 119, row }, 60 } };
+    }
+
+    std::vector<ParameterPanel::Control> getLfoControls()
+    {
+        return { { Kind::comboBox, Processor::LFO_WAVE,         "LFO 1 Wave",         { 5,   top,           90,  row } },
+                 { Kind::slider,   Processor::LFO_RATE,         "LFO 1 Rate",         { 100, top,           125, row }, 50 },
+                 { Kind::slider,   Processor::LFO_DEPTH,        "LFO 1 Cutoff Depth", { 225, top,           125, row }, 50 },
+                 { Kind::slider,   Processor::LFO_STEREO_PHASE, "LFO Stereo Phase",   { 350, top,           125, row }, 40 },
+                 { Kind::comboBox, Processor::LFO2_WAVE,        "LFO 2 Wave",         { 5,   top + row + 4, 90,  row } },
+                 { Kind::slider,   Processor::LFO2_RATE,        "LFO 2 Rate",         { 100, top + row + 4, 125, row }, 50 } };
+    }
+
+    std::vector<ParameterPanel::Control> getModulationControls()
+    {
+        std::vector<ParameterPanel::Control> controls;
+
+        // Two routes to a row, each as source, destination and depth
+        for (size_t route = 0; route < (size_t) ModulationMatrix::maxRoutes; ++route)
+        {
+            const auto x = 5 + (int) (route % 2) * 237;
+            const auto y = top + (int) (route / 2) * (row + 4);
+            const auto name = "Mod " + juce::String ((int) route + 1);
+
+            controls.push_back ({ Kind::comboBox, Processor::MOD_SOURCE[route],      name + " Source", { x,       y, 75, row } });
+            controls.push_back ({ Kind::comboBox, Processor::MOD_DESTINATION[route], name + " Target", { x + 77,  y, 75, row } });
+            controls.push_back ({ Kind::slider,   Processor::MOD_DEPTH[route],       name + " Depth",  { x + 154, y, 79, row }, 36 });
+        }
+
+        return controls;
+    }
+}
+
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor& p)
-    : AudioProcessorEditor (&p), processorRef (p)
+    : AudioProcessorEditor (&p),
+      processorRef (p),
+      openStartTime (juce::Time::getMillisecondCounterHiRes()),
+      content (*this),
+      oscillatorPanel ("Oscillators", p.apvts, getOscillatorControls()),
+      filterPanel ("Filter", p.apvts, getFilterControls()),
+      envelopePanel ("Envelope", p.apvts, getEnvelopeControls()),
+      lfoPanel ("LFOs", p.apvts, getLfoControls()),
+      modulationPanel ("Modulation", p.apvts, getModulationControls())
 {
-    setSize (500, 460);
+    // The content is laid out once, at the design size; resized() only scales it
+    content.setBounds (0, 0, designWidth, designHeight);
+    addAndMakeVisible (content);
 
     masterEnabledButton.setButtonText ("Master On/Off");
-    addAndMakeVisible (masterEnabledButton);
+    masterEnabledButton.setBounds (10, 10, 100, 40);
+    content.addAndMakeVisible (masterEnabledButton);
     masterEnabledButton.addListener (this);
 
-    osc1FreqSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    osc1FreqSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (osc1FreqSlider);
-    osc1FreqLabel.setText ("Oscillator 1 Frequency", juce::dontSendNotification);
-    osc1FreqLabel.setJustificationType (juce::Justification::centred);
-    osc1FreqLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (osc1FreqLabel);
-
-    osc2FreqSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    osc2FreqSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (osc2FreqSlider);
-    osc2FreqLabel.setText ("Oscillator 2 Frequency", juce::dontSendNotification);
-    osc2FreqLabel.setJustificationType (juce::Justification::centred);
-    osc2FreqLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (osc2FreqLabel);
-    
-    oscMixSlider.setSliderStyle (juce::Slider::SliderStyle::Rotary);
-    oscMixSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, true, 100, 25);
-    addAndMakeVisible (oscMixSlider);
-    oscMixLabel.setText ("Oscillator Mix", juce::dontSendNotification);
-    oscMixLabel.setJustificationType (juce::Justification::centred);
-    oscMixLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (oscMixLabel);
-
-    addAndMakeVisible (osc1WaveTypeComboBox);
-    osc1WaveTypeComboBox.addItemList ({ "Sine", "Saw", "Square", "Triangle" }, 1);
-    osc1WaveTypeLabel.setText ("Oscillator 1 Wave", juce::dontSendNotification);
-    osc1WaveTypeLabel.setJustificationType (juce::Justification::centred);
-    osc1WaveTypeLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (osc1WaveTypeLabel);
-
-    addAndMakeVisible (osc2WaveTypeComboBox);
-    osc2WaveTypeComboBox.addItemList ({ "Sine", "Saw", "Square", "Triangle" }, 1);
-    osc2WaveTypeLabel.setText ("Oscillator 2 Wave", juce::dontSendNotification);
-    osc2WaveTypeLabel.setJustificationType (juce::Justification::centred);
-    osc2WaveTypeLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (osc2WaveTypeLabel);
-
-    osc1FreqAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::OSC1_FREQ, osc1FreqSlider);
-    osc2FreqAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::OSC2_FREQ, osc2FreqSlider);
-    oscMixAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::OSC_MIX, oscMixSlider);
-    
-    osc1WaveTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (processorRef.apvts, AudioPluginAudioProcessor::OSC1_WAVE, osc1WaveTypeComboBox);
-    osc2WaveTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (processorRef.apvts, AudioPluginAudioProcessor::OSC2_WAVE, osc2WaveTypeComboBox);
-
-    addAndMakeVisible (filterTypeComboBox);
-    filterTypeComboBox.addItemList ({ "Lowpass", "Bandpass", "Highpass" }, 1);
-    filterTypeLabel.setText ("Filter Type", juce::dontSendNotification);
-    filterTypeLabel.setJustificationType (juce::Justification::centred);
-    filterTypeLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (filterTypeLabel);
-
-    filterCutoffSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    filterCutoffSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (filterCutoffSlider);
-    filterCutoffLabel.setText ("Filter Cutoff", juce::dontSendNotification);
-    filterCutoffLabel.setJustificationType (juce::Justification::centred);
-    filterCutoffLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (filterCutoffLabel);
-
-    filterResonanceSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    filterResonanceSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (filterResonanceSlider);
-    filterResonanceLabel.setText ("Filter Resonance", juce::dontSendNotification);
-    filterResonanceLabel.setJustificationType (juce::Justification::centred);
-    filterResonanceLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (filterResonanceLabel);
-
-    filterTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (processorRef.apvts, AudioPluginAudioProcessor::FILTER_TYPE, filterTypeComboBox);
-    filterCutoffAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::FILTER_CUTOFF, filterCutoffSlider);
-    filterResonanceAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::FILTER_RESONANCE, filterResonanceSlider);
-
-    attackSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    attackSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (attackSlider);
-    attackLabel.setText ("Attack", juce::dontSendNotification);
-    attackLabel.setJustificationType (juce::Justification::centred);
-    attackLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (attackLabel);
-
-    decaySlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    decaySlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (decaySlider);
-    decayLabel.setText ("Decay", juce::dontSendNotification);
-    decayLabel.setJustificationType (juce::Justification::centred);
-    decayLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (decayLabel);
-
-    sustainSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    sustainSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (sustainSlider);
-    sustainLabel.setText ("Sustain", juce::dontSendNotification);
-    sustainLabel.setJustificationType (juce::Justification::centred);
-    sustainLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (sustainLabel);
-
-    releaseSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    releaseSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (releaseSlider);
-    releaseLabel.setText ("Release", juce::dontSendNotification);
-    releaseLabel.setJustificationType (juce::Justification::centred);
-    releaseLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (releaseLabel);
-
-    attackAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::ATTACK, attackSlider);
-    decayAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::DECAY, decaySlider);
-    sustainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::SUSTAIN, sustainSlider);
-    releaseAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::RELEASE, releaseSlider);
-
-    lfoRateSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    lfoRateSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (lfoRateSlider);
-    lfoRateLabel.setText ("LFO Rate", juce::dontSendNotification);
-    lfoRateLabel.setJustificationType (juce::Justification::centred);
-    lfoRateLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (lfoRateLabel);
-
-    lfoDepthSlider.setSliderStyle (juce::Slider::SliderStyle::LinearHorizontal);
-    lfoDepthSlider.setTextBoxStyle (juce::Slider::TextBoxRight, true, 100, 25);
-    addAndMakeVisible (lfoDepthSlider);
-    lfoDepthLabel.setText ("LFO Depth", juce::dontSendNotification);
-    lfoDepthLabel.setJustificationType (juce::Justification::centred);
-    lfoDepthLabel.setColour (juce::Label::textColourId, juce::Colours::white);
-    addAndMakeVisible (lfoDepthLabel);
-
     masterAlwaysOnButton.setButtonText ("Always On");
-    addAndMakeVisible (masterAlwaysOnButton);
-
-    lfoRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::LFO_RATE, lfoRateSlider);
-    lfoDepthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (processorRef.apvts, AudioPluginAudioProcessor::LFO_DEPTH, lfoDepthSlider);
+    masterAlwaysOnButton.setBounds (115, 10, 100, 40);
+    content.addAndMakeVisible (masterAlwaysOnButton);
     masterAlwaysOnAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (processorRef.apvts, AudioPluginAudioProcessor::MASTER_ALWAYS_ON, masterAlwaysOnButton);
+
+    oscillatorPanel.setBounds (10, 55, 480, 165);
+    filterPanel.setBounds (10, 225, 480, 70);
+    envelopePanel.setBounds (10, 300, 480, 70);
+    lfoPanel.setBounds (10, 375, 480, 120);
+    modulationPanel.setBounds (10, 500, 480, 120);
+
+    for (auto* panel : { &oscillatorPanel, &filterPanel, &envelopePanel, &lfoPanel, &modulationPanel })
+        content.addAndMakeVisible (panel);
+
+    // Typing a name and pressing "Save Preset" adds the current settings to
+    // the bank under that name
+    presetComboBox.setEditableText (true);
+    presetComboBox.setTextWhenNothingSelected ("Presets");
+    presetComboBox.onChange = [this]
+    {
+        const auto index = presetComboBox.getSelectedId() - 1;
+
+        if (index >= 0 && index != processorRef.getCurrentProgram())
+        {
+            processorRef.setCurrentProgram (index);
+            processorRef.updateHostDisplay (juce::AudioProcessor::ChangeDetails().withProgramChanged (true));
+        }
+    };
+    presetComboBox.setBounds (10, 630, 380, 30);
+    content.addAndMakeVisible (presetComboBox);
+    refreshPresetList();
+
+    savePresetButton.setButtonText ("Save Preset");
+    savePresetButton.setBounds (400, 630, 90, 30);
+    content.addAndMakeVisible (savePresetButton);
+    savePresetButton.addListener (this);
+
+    // Items in the order of the setting's values, 0 workers first
+    voiceThreadsComboBox.addItemList ({ "Audio Thread Only", "1 Worker Thread", "2 Worker Threads", "3 Worker Threads" }, 1);
+    voiceThreadsComboBox.setBounds (500, 630, 140, 30);
+    content.addAndMakeVisible (voiceThreadsComboBox);
+    voiceThreadsAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (processorRef.apvts, AudioPluginAudioProcessor::VOICE_THREADS, voiceThreadsComboBox);
+
+    loadWaveButton.setButtonText ("Load User Wave...");
+    loadWaveButton.setBounds (650, 630, 140, 30);
+    content.addAndMakeVisible (loadWaveButton);
+    loadWaveButton.addListener (this);
+
+    // A host has its own ways of looking into dropouts, the Standalone app
+    // only has this
+    if (processorRef.wrapperType == juce::AudioProcessor::wrapperType_Standalone)
+    {
+        presetComboBox.setBounds (10, 630, 285, 30);
+
+        traceButton.setButtonText ("Dump Trace");
+        traceButton.setBounds (305, 630, 85, 30);
+        content.addAndMakeVisible (traceButton);
+        traceButton.addListener (this);
+    }
+
+    if (RealtimeMonitor::isEnabled())
+    {
+        realtimeStatusLabel.setFont (realtimeStatusLabel.getFont().withHeight (11.0f));
+        realtimeStatusLabel.setJustificationType (juce::Justification::topLeft);
+        realtimeStatusLabel.setColour (juce::Label::textColourId, juce::Colours::white);
+        realtimeStatusLabel.setBounds (220, 10, 175, 40);
+        content.addAndMakeVisible (realtimeStatusLabel);
+
+        realtimeReportButton.setButtonText ("Dump Report");
+        realtimeReportButton.setBounds (400, 10, 90, 40);
+        content.addAndMakeVisible (realtimeReportButton);
+        realtimeReportButton.addListener (this);
+
+        timerCallback();
+        startTimerHz (4);
+    }
+
+    setResizable (true, true);
+    setResizeLimits (designWidth * 3 / 4, designHeight * 3 / 4, designWidth * 2, designHeight * 2);
+    getConstrainer()->setFixedAspectRatio ((double) designWidth / designHeight);
+    setSize (designWidth, designHeight);
+
+    openTimings.constructed = getElapsedMilliseconds();
+    triggerAsyncUpdate();
 }
 
 AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor()
-= default;
+{
+    cancelPendingUpdate();
+}
 
-void AudioPluginAudioProcessorEditor::paint (juce::Graphics& g)
+//==============================================================================
+void AudioPluginAudioProcessorEditor::handleAsyncUpdate()
 {
-    g.fillAll (juce::Colours::black);
+    // One piece per message loop turn, so the host stays responsive while the
+    // editor fills in
+    if (populateNext())
+    {
+        triggerAsyncUpdate();
+        return;
+    }
+
+    openTimings.populated = getElapsedMilliseconds();
 }
 
-void AudioPluginAudioProcessorEditor::resized()
+void AudioPluginAudioProcessorEditor::populateAll()
 {
-    masterEnabledButton.setBounds (10, 10, 100, 50);
-    
-    osc1WaveTypeLabel.setBounds (120, 10, 90, 20);
-    osc1WaveTypeComboBox.setBounds (120, 30, 90, 30);
+    cancelPendingUpdate();
 
-    osc1FreqLabel.setBounds (220, 10, 270, 20);
-    osc1FreqSlider.setBounds (220, 30, 270, 30);
+    while (populateNext())
+        ;
 
-    osc2WaveTypeLabel.setBounds (120, 70, 90, 20);
-    osc2WaveTypeComboBox.setBounds (120, 90, 90, 30);
-    
-    osc2FreqLabel.setBounds (220, 70, 270, 20);
-    osc2FreqSlider.setBounds (220, 90, 270, 30);
-    
-    oscMixLabel.setBounds (10, 70, 100, 20);
-    oscMixSlider.setBounds (10, 90, 100, 100);
+    if (openTimings.populated == 0.0)
+        openTimings.populated = getElapsedMilliseconds();
+}
 
-    filterTypeLabel.setBounds (10, 190, 100, 20);
-    filterTypeComboBox.setBounds (10, 210, 100, 30);
+bool AudioPluginAudioProcessorEditor::populateNext()
+{
+    for (auto* panel : { &oscillatorPanel, &filterPanel, &envelopePanel, &lfoPanel, &modulationPanel })
+    {
+        if (! panel->isPopulated())
+        {
+            panel->populate();
+            return true;
+        }
+    }
 
-    filterCutoffLabel.setBounds (120, 190, 370, 20);
-    filterCutoffSlider.setBounds (120, 210, 370, 30);
+    // Last, as they start their own threads
+    if (curveView == nullptr)
+    {
+        curveView = std::make_unique<CurveView> (processorRef);
+        curveView->setBounds (500, 345, 290, 275);
+        content.addAndMakeVisible (*curveView);
+        return true;
+    }
+
+    if (telemetryView == nullptr)
+    {
+        telemetryView = std::make_unique<TelemetryView> (processorRef.getTelemetry());
+        telemetryView->setBounds (500, 10, 290, 330);
+        content.addAndMakeVisible (*telemetryView);
+        return true;
+    }
+
+    return false;
+}
 
-    filterResonanceLabel.setBounds (10, 240, 370, 20);
-    filterResonanceSlider.setBounds (10, 260, 370, 30);
+double AudioPluginAudioProcessorEditor::getElapsedMilliseconds() const
+{
+    return juce::Time::getMillisecondCounterHiRes() - openStartTime;
+}
 
-    attackLabel.setBounds (10, 290, 120, 20);
-    attackSlider.setBounds (10, 310, 120, 30);
+//==============================================================================
+void AudioPluginAudioProcessorEditor::paint (juce::Graphics&)
+{
+    // The content covers the whole editor
+}
 
-    decayLabel.setBounds (130, 290, 120, 20);
-    decaySlider.setBounds (130, 310, 120, 30);
+void AudioPluginAudioProcessorEditor::paintContent (juce::Graphics& g)
+{
+    if (openTimings.firstPaint == 0.0)
+        openTimings.firstPaint = getElapsedMilliseconds();
 
-    sustainLabel.setBounds (250, 290, 120, 20);
-    sustainSlider.setBounds (250, 310, 120, 30);
+    // Frames and titles never change, so they're drawn once into an image at
+    // the physical resolution, and repaints only copy the invalidated part
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
 
-    releaseLabel.setBounds (370, 290, 120, 20);
-    releaseSlider.setBounds (370, 310, 120, 30);
+    if (! background.isValid() || ! juce::approximatelyEqual (scale, backgroundScale))
+    {
+        backgroundScale = scale;
+        background = juce::Image (juce::Image::RGB, juce::roundToInt ((float) designWidth * scale),
+                                  juce::roundToInt ((float) designHeight * scale), false);
 
-    lfoRateLabel.setBounds (10, 340, 240, 20);
-    lfoRateSlider.setBounds (10, 360, 240, 30);
+        juce::Graphics backgroundGraphics (background);
+        backgroundGraphics.addTransform (juce::AffineTransform::scale (scale));
+        backgroundGraphics.fillAll (juce::Colours::black);
 
-    lfoDepthLabel.setBounds (250, 340, 240, 20);
-    lfoDepthSlider.setBounds (250, 360, 240, 30);
+        for (auto* panel : { &oscillatorPanel, &filterPanel, &envelopePanel, &lfoPanel, &modulationPanel })
+            panel->paintFrame (backgroundGraphics);
+    }
 
-    masterAlwaysOnButton.setBounds (10, 400, 100, 50);
+    g.drawImageTransformed (background, juce::AffineTransform::scale (1.0f / scale));
+}
+
+void AudioPluginAudioProcessorEditor::resized()
+{
+    content.setTransform (juce::AffineTransform::scale ((float) getWidth() / (float) designWidth));
+}
+
+void AudioPluginAudioProcessorEditor::refreshPresetList()
+{
+    presetComboBox.clear (juce::dontSendNotification);
+
+    for (int i = 0; i < processorRef.getNumPrograms(); ++i)
+    {
+        const auto name = processorRef.getProgramName (i);
+
+        if (name.isNotEmpty())
+            presetComboBox.addItem (name, i + 1);
+    }
+
+    presetComboBox.setSelectedId (processorRef.getCurrentProgram() + 1, juce::dontSendNotification);
+}
+
+void AudioPluginAudioProcessorEditor::timerCallback()
+{
+    const auto snapshot = processorRef.getRealtimeMonitor().getSnapshot();
+    realtimeStatusLabel.setText (snapshot.toString(), juce::dontSendNotification);
+    realtimeStatusLabel.setColour (juce::Label::textColourId, snapshot.blocksWithViolations > 0 || snapshot.deadlineMisses > 0
+                                                                ? juce::Colours::orangered
+                                                                : juce::Colours::white);
 }
 
 void AudioPluginAudioProcessorEditor::buttonClicked (juce::Button* button)
@@ -208,4 +309,36 @@ void AudioPluginAudioProcessorEditor::buttonClicked (juce::Button* button)
         auto* param = static_cast<juce::AudioParameterBool*> (processorRef.apvts.getParameter (AudioPluginAudioProcessor::MASTER_ENABLED));
         param->setValueNotifyingHost (!param->get());
     }
+    else if (button == &savePresetButton)
+    {
+        const auto name = presetComboBox.getText().trim();
+
+        if (name.isNotEmpty() && processorRef.addPreset (name).wasOk())
+            refreshPresetList();
+    }
+    else if (button == &traceButton)
+    {
+        const auto file = processorRef.writeBlockTrace();
+        traceButton.setTooltip ("Written to " + file.getFullPathName());
+    }
+    else if (button == &realtimeReportButton)
+    {
+        const auto file = processorRef.writeRealtimeReport();
+        realtimeReportButton.setTooltip ("Written to " + file.getFullPathName());
+    }
+    else if (button == &loadWaveButton)
+    {
+        waveChooser = std::make_unique<juce::FileChooser> ("Load a single cycle for the User wave", juce::File(), "*.wav;*.aif;*.aiff;*.flac");
+        waveChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                  [this] (const juce::FileChooser& chooser)
+                                  {
+                                      const auto file = chooser.getResult();
+
+                                      if (file == juce::File())
+                                          return;
+
+                                      loadWaveButton.setTooltip (processorRef.loadUserWaveform (file) ? "Loaded " + file.getFileName()
+                                                                                                        : file.getFileName() + " isn't a single cycle");
+                                  });
+    }
 }
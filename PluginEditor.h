@@ -1,10 +1,27 @@
 #pragma once
 
+#include "CurveView.h"
+#include "ParameterPanel.h"
 #include "PluginProcessor.h"
+#include "TelemetryView.h"
 
 //==============================================================================
+/** The plugin's window.
+
+    The parameter controls live in one ParameterPanel per section. The
+    constructor only creates the panels' frames and the few top level
+    controls; the panels' contents, the curves and the telemetry view are
+    created one per message loop turn after that, so opening many editors
+    doesn't hold up the host. getOpenTimings() says how long each step took.
+
+    Everything is laid out once at the design size and scaled as a whole to
+    the window's size, on a background that's only rendered again when the
+    physical scale changes.
+*/
 class AudioPluginAudioProcessorEditor final : public juce::AudioProcessorEditor,
-                                          public juce::Button::Listener
+                                          public juce::Button::Listener,
+                                          private juce::Timer,
+                                          private juce::AsyncUpdater
 {
 public:
     explicit AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor&);
@@ -15,63 +32,80 @@ public:
     void resized() override;
     void buttonClicked (juce::Button* button) override;
 
+    /** Milliseconds from the start of the constructor to each stage of opening,
+        0 for the stages not reached yet.
+    */
+    struct OpenTimings
+    {
+        double constructed = 0.0;
+        double firstPaint = 0.0;
+        double populated = 0.0;     // every panel filled in
+    };
+
+    const OpenTimings& getOpenTimings() const   { return openTimings; }
+
+    /** Fills in whatever is still empty right away, rather than over the next
+        message loop turns.
+    */
+    void populateAll();
+
+    static constexpr int designWidth = 800;
+    static constexpr int designHeight = 670;
+
 private:
+    struct Content final : public juce::Component
+    {
+        explicit Content (AudioPluginAudioProcessorEditor& e) : editor (e)  { setOpaque (true); }
+        void paint (juce::Graphics& g) override                             { editor.paintContent (g); }
+
+        AudioPluginAudioProcessorEditor& editor;
+    };
+
+    void timerCallback() override;
+    void handleAsyncUpdate() override;
+
+    bool populateNext();
+    void paintContent (juce::Graphics&);
+    void refreshPresetList();
+    double getElapsedMilliseconds() const;
+
     AudioPluginAudioProcessor& processorRef;
 
+    const double openStartTime;
+    OpenTimings openTimings;
+
+    Content content;
+    juce::Image background;
+    float backgroundScale = 0.0f;
+
     juce::TextButton masterEnabledButton;
-    juce::Slider osc1FreqSlider;
-    juce::Label osc1FreqLabel;
-    juce::Slider osc2FreqSlider;
-    juce::Label osc2FreqLabel;
-    juce::Slider oscMixSlider;
-    juce::Label oscMixLabel;
-    
-    juce::ComboBox osc1WaveTypeComboBox;
-    juce::Label osc1WaveTypeLabel;
-    juce::ComboBox osc2WaveTypeComboBox;
-    juce::Label osc2WaveTypeLabel;
-    
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> osc1FreqAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> osc2FreqAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> oscMixAttachment;
-    
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> osc1WaveTypeAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> osc2WaveTypeAttachment;
-
-    juce::ComboBox filterTypeComboBox;
-    juce::Label filterTypeLabel;
-    juce::Slider filterCutoffSlider;
-    juce::Label filterCutoffLabel;
-    juce::Slider filterResonanceSlider;
-    juce::Label filterResonanceLabel;
-
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> filterTypeAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> filterCutoffAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> filterResonanceAttachment;
-
-    juce::Slider attackSlider;
-    juce::Label attackLabel;
-    juce::Slider decaySlider;
-    juce::Label decayLabel;
-    juce::Slider sustainSlider;
-    juce::Label sustainLabel;
-    juce::Slider releaseSlider;
-    juce::Label releaseLabel;
-
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> attackAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> decayAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sustainAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> releaseAttachment;
-
-    juce::Slider lfoRateSlider;
-    juce::Label lfoRateLabel;
-    juce::Slider lfoDepthSlider;
-    juce::Label lfoDepthLabel;
     juce::TextButton masterAlwaysOnButton;
-
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lfoRateAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lfoDepthAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> masterAlwaysOnAttachment;
 
+    ParameterPanel oscillatorPanel;
+    ParameterPanel filterPanel;
+    ParameterPanel envelopePanel;
+    ParameterPanel lfoPanel;
+    ParameterPanel modulationPanel;
+
+    juce::ComboBox presetComboBox;
+    juce::TextButton savePresetButton;
+
+    juce::ComboBox voiceThreadsComboBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> voiceThreadsAttachment;
+
+    juce::TextButton loadWaveButton;
+    std::unique_ptr<juce::FileChooser> waveChooser;
+
+    // Only shown in the Standalone app
+    juce::TextButton traceButton;
+
+    std::unique_ptr<CurveView> curveView;
+    std::unique_ptr<TelemetryView> telemetryView;
+
+    // Only shown in builds with NEUTRON_REALTIME_CHECKS
+    juce::Label realtimeStatusLabel;
+    juce::TextButton realtimeReportButton;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessorEditor)
 };
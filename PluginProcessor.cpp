@@ -7,6 +7,10 @@ const juce::String AudioPluginAudioProcessor::MASTER_ENABLED = "MASTER_ENABLED";
 const juce::String AudioPluginAudioProcessor::OSC1_FREQ = "OSC1_FREQ";
 const juce::String AudioPluginAudioProcessor::OSC2_FREQ = "OSC2_FREQ";
 const juce::String AudioPluginAudioProcessor::OSC_MIX = "OSC_MIX";
+const juce::String AudioPluginAudioProcessor::UNISON_VOICES = "UNISON_VOICES";
+const juce::String AudioPluginAudioProcessor::UNISON_DETUNE = "UNISON_DETUNE";
+const juce::String AudioPluginAudioProcessor::UNISON_WIDTH = "UNISON_WIDTH";
+const juce::String AudioPluginAudioProcessor::PAN_SPREAD = "PAN_SPREAD";
 const juce::String AudioPluginAudioProcessor::FILTER_TYPE = "FILTER_TYPE";
 const juce::String AudioPluginAudioProcessor::FILTER_CUTOFF = "FILTER_CUTOFF";
 const juce::String AudioPluginAudioProcessor::FILTER_RESONANCE = "FILTER_RESONANCE";
@@ -16,7 +20,15 @@ const juce::String AudioPluginAudioProcessor::SUSTAIN = "SUSTAIN";
 const juce::String AudioPluginAudioProcessor::RELEASE = "RELEASE";
 const juce::String AudioPluginAudioProcessor::LFO_RATE = "LFO_RATE";
 const juce::String AudioPluginAudioProcessor::LFO_DEPTH = "LFO_DEPTH";
+const juce::String AudioPluginAudioProcessor::LFO_STEREO_PHASE = "LFO_STEREO_PHASE";
 const juce::String AudioPluginAudioProcessor::MASTER_ALWAYS_ON = "MASTER_ALWAYS_ON";
+const juce::String AudioPluginAudioProcessor::LFO_WAVE = "LFO_WAVE";
+const juce::String AudioPluginAudioProcessor::LFO2_RATE = "LFO2_RATE";
+const juce::String AudioPluginAudioProcessor::LFO2_WAVE = "LFO2_WAVE";
+const juce::String AudioPluginAudioProcessor::VOICE_THREADS = "VOICE_THREADS";
+const std::array<juce::String, ModulationMatrix::maxRoutes> AudioPluginAudioProcessor::MOD_SOURCE { "MOD1_SOURCE", "MOD2_SOURCE", "MOD3_SOURCE", "MOD4_SOURCE" };
+const std::array<juce::String, ModulationMatrix::maxRoutes> AudioPluginAudioProcessor::MOD_DESTINATION { "MOD1_DESTINATION", "MOD2_DESTINATION", "MOD3_DESTINATION", "MOD4_DESTINATION" };
+const std::array<juce::String, ModulationMatrix::maxRoutes> AudioPluginAudioProcessor::MOD_DEPTH { "MOD1_DEPTH", "MOD2_DEPTH", "MOD3_DEPTH", "MOD4_DEPTH" };
 
 //==============================================================================
 AudioPluginAudioProcessor::AudioPluginAudioProcessor()
@@ -30,22 +42,20 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
                        ),
        apvts (*this, nullptr, "Parameters", createParameters())
 {
-    osc1WaveType = apvts.getRawParameterValue (OSC1_WAVE);
-    osc2WaveType = apvts.getRawParameterValue (OSC2_WAVE);
-    filterType = apvts.getRawParameterValue (FILTER_TYPE);
-    filterCutoff = apvts.getRawParameterValue (FILTER_CUTOFF);
-    filterResonance = apvts.getRawParameterValue (FILTER_RESONANCE);
-    attack = apvts.getRawParameterValue (ATTACK);
-    decay = apvts.getRawParameterValue (DECAY);
-    sustain = apvts.getRawParameterValue (SUSTAIN);
-    release = apvts.getRawParameterValue (RELEASE);
-    lfoRate = apvts.getRawParameterValue (LFO_RATE);
-    lfoDepth = apvts.getRawParameterValue (LFO_DEPTH);
-    masterAlwaysOn = apvts.getRawParameterValue (MASTER_ALWAYS_ON);
+    auto bank = std::make_shared<PresetBank>();
+    bank->open (getPresetBankFile(), presetLayout);
+    presetBank = std::move (bank);
+
+    voicePool.setTrace (&blockTrace);
 }
 
 AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
-= default;
+{
+    // The Standalone app has nowhere else to show them, so leave the numbers
+    // behind when it quits
+    if (RealtimeMonitor::isEnabled() && wrapperType == wrapperType_Standalone)
+        writeRealtimeReport();
+}
 
 //==============================================================================
 const juce::String AudioPluginAudioProcessor::getName() const
@@ -70,52 +80,202 @@ bool AudioPluginAudioProcessor::isMidiEffect() const
 
 double AudioPluginAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The envelope comes after the filter, so a voice is silent the moment its
+    // release ends and the filter has no ringing of its own to add
+    return (double) apvts.getRawParameterValue (RELEASE)->load();
 }
 
 int AudioPluginAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    // so this should be at least 1, even without a preset bank
+    return juce::jmax (1, getPresetBank()->getNumPresets());
 }
 
 int AudioPluginAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void AudioPluginAudioProcessor::setCurrentProgram (int index)
 {
-    juce::ignoreUnused (index);
+    std::vector<float> values ((size_t) presetLayout.getNumParameters());
+
+    if (! getPresetBank()->getValues (index, values.data()))
+        return;
+
+    // How many threads render is a setting of the machine, not of the sound
+    if (const auto threads = presetLayout.indexOf (PresetLayout::makeKey (VOICE_THREADS)); threads >= 0)
+        values[(size_t) threads] = (float) getNumVoiceThreads();
+
+    currentProgram = index;
+    applyPresetValues (values.data());
 }
 
 const juce::String AudioPluginAudioProcessor::getProgramName (int index)
 {
-    juce::ignoreUnused (index);
-    return {};
+    return getPresetBank()->getName (index);
 }
 
 void AudioPluginAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
-    juce::ignoreUnused (index, newName);
+    rewritePresetBank ([index, &newName] (auto& presets)
+    {
+        if (juce::isPositiveAndBelow (index, (int) presets.size()))
+            presets[(size_t) index].name = newName;
+    });
+}
+
+juce::File AudioPluginAudioProcessor::getPresetBankFile()
+{
+    return PresetBank::getCurrentFile (getPresetIndexFile());
+}
+
+juce::File AudioPluginAudioProcessor::getPresetIndexFile()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile (JucePlugin_Name)
+               .getChildFile ("Presets.index");
+}
+
+juce::Result AudioPluginAudioProcessor::addPreset (const juce::String& name)
+{
+    PresetBank::Preset preset { name, std::vector<float> ((size_t) presetLayout.getNumParameters()) };
+    presetLayout.getCurrentValues (preset.values.data());
+
+    auto result = rewritePresetBank ([&preset] (auto& presets) { presets.push_back (std::move (preset)); });
+
+    if (result.wasOk())
+    {
+        currentProgram = getPresetBank()->getNumPresets() - 1;
+        updateHostDisplay (ChangeDetails().withProgramChanged (true));
+    }
+
+    return result;
+}
+
+std::shared_ptr<const PresetBank> AudioPluginAudioProcessor::getPresetBank() const
+{
+    const juce::SpinLock::ScopedLockType lock (presetBankLock);
+    return presetBank;
+}
+
+juce::Result AudioPluginAudioProcessor::rewritePresetBank (const std::function<void (std::vector<PresetBank::Preset>&)>& edit)
+{
+    // Every instance edits the same file, in this process or another one, so
+    // the edit starts from what is on disk now rather than from the copy this
+    // instance mapped when it opened. File locks don't keep out threads of the
+    // same process, hence the second lock.
+    static juce::CriticalSection processLock;
+    const juce::ScopedLock scopedProcessLock (processLock);
+
+    juce::InterProcessLock fileLock (juce::String (JucePlugin_Name) + " Presets");
+    const juce::InterProcessLock::ScopedLockType scopedFileLock (fileLock);
+
+    if (! scopedFileLock.isLocked())
+        return juce::Result::fail ("Couldn't lock the preset bank");
+
+    const auto indexFile = getPresetIndexFile();
+    std::vector<PresetBank::Preset> presets;
+
+    {
+        PresetBank onDisk;
+        onDisk.open (PresetBank::getCurrentFile (indexFile), presetLayout);
+
+        for (int i = 0; i < onDisk.getNumPresets(); ++i)
+            presets.push_back (onDisk.getPreset (i));
+    }
+
+    edit (presets);
+
+    indexFile.getParentDirectory().createDirectory();
+    auto result = PresetBank::write (indexFile, presetLayout, presets);
+
+    // Programs are looked up on whatever thread the host likes, so the new
+    // bank replaces the old one in a single step. The old one is unmapped
+    // once the last of those calls has let go of it.
+    auto bank = std::make_shared<PresetBank>();
+    bank->open (PresetBank::getCurrentFile (indexFile), presetLayout);
+    std::shared_ptr<const PresetBank> previous = std::move (bank);
+
+    {
+        const juce::SpinLock::ScopedLockType lock (presetBankLock);
+        std::swap (presetBank, previous);
+    }
+
+    return result;
+}
+
+void AudioPluginAudioProcessor::applyPresetValues (const float* values)
+{
+    // The audio thread fades out and keeps the values it had until every
+    // parameter has been written
+    presetSwitch.beginChange();
+    presetLayout.setValues (values);
+    presetSwitch.endChange();
 }
 
 //==============================================================================
 void AudioPluginAudioProcessor::prepareToPlay (double newSampleRate, int samplesPerBlock)
 {
     sampleRate = newSampleRate;
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = static_cast<juce::uint32> (samplesPerBlock);
-    spec.sampleRate = newSampleRate;
-    spec.numChannels = static_cast<juce::uint32> (getTotalNumOutputChannels());
-    
-    filter.prepare (spec);
-    filter.reset();
-    adsr.setSampleRate (newSampleRate);
+
+    // Offline renders update parameters, the LFO and the filter on a finer
+    // grid, and use exact rather than draft math. This is picked up here, so
+    // hosts switching to offline bouncing get it once they re-prepare.
+    const auto controlInterval = isNonRealtime() ? offlineControlInterval : realtimeControlInterval;
+    accuracy = isNonRealtime() ? FastMath::Accuracy::exact : FastMath::Accuracy::draft;
+
+    wavetables.prepare (newSampleRate);
+    voicePool.setAccuracy (accuracy);
+    voicePool.setFilterControlInterval (controlInterval);
+    voicePool.prepare (newSampleRate, wavetables);
+
+    // Workers only pay off with many voices busy, see the "threads" benchmark
+    // suite. Below that the pool keeps rendering on the audio thread, and it
+    // never runs more threads than there are cores.
+    const auto numWorkers = juce::jmin (getNumVoiceThreads(), juce::SystemStats::getNumCpus() - 1);
+
+    if (numWorkers > 0)
+    {
+        voiceThreads.start (numWorkers, samplesPerBlock, newSampleRate);
+        voicePool.setThreadPool (&voiceThreads);
+    }
+    else
+    {
+        voiceThreads.stop();
+        voicePool.setThreadPool (nullptr);
+    }
+
+    // Both LFOs start a new stream at the top of their cycle, so an offline
+    // render doesn't depend on how long the processor ran before it
+    lfoPhase = 0.0f;
+    lfo2Phase = 0.0f;
+
+    scheduler.reset (controlInterval);
+    presetSwitch.prepare (newSampleRate);
+    telemetry.prepare (newSampleRate);
+    blockTrace.prepare (newSampleRate);
+    parameterReader.prepare (newSampleRate, controlInterval);
+    voiceBuffer.setSize (2, scheduler.getTickInterval());
+    previousAlwaysOnState = false;
+    idle = false;
+}
+
+void AudioPluginAudioProcessor::setNumVoiceThreads (int numWorkers)
+{
+    auto* parameter = apvts.getParameter (VOICE_THREADS);
+    parameter->setValueNotifyingHost (parameter->convertTo0to1 ((float) numWorkers));
+}
+
+int AudioPluginAudioProcessor::getNumVoiceThreads() const
+{
+    return (int) apvts.getRawParameterValue (VOICE_THREADS)->load();
 }
 
 void AudioPluginAudioProcessor::releaseResources()
 {
+    voiceThreads.stop();
 }
 
 bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -130,128 +290,262 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
     return true;
 }
 
-double AudioPluginAudioProcessor::getOscillatorSample (double angle, int waveType)
+void AudioPluginAudioProcessor::handleMidiEvent (const juce::MidiMessage& message)
+{
+    if (message.isNoteOn())
+        voicePool.noteOn (message.getNoteNumber(), message.getFloatVelocity());
+    else if (message.isNoteOff())
+        voicePool.noteOff (message.getNoteNumber());
+    else if (message.isAllNotesOff() || message.isAllSoundOff())
+        voicePool.allNotesOff();
+}
+
+void AudioPluginAudioProcessor::updateRenderParameters()
 {
-    switch (waveType)
+    if (presetSwitch.beginTick())
+        parameterReader.jumpToCurrentValues();
+
+    const auto& snapshot = parameterReader.capture (presetSwitch);
+    auto& params = renderParameters;
+    auto changes = snapshot.changes;
+
+    if (snapshot.hasChanged (VoiceRenderParameters::envelopeChanged))
+        params.envelope = snapshot.envelope;
+
+    if (snapshot.hasChanged (VoiceRenderParameters::waveTypesChanged))
     {
-        case 0: // Sine
-            return std::sin (angle);
-        case 1: // Saw
-            return (angle / juce::MathConstants<double>::pi) - 1.0;
-        case 2: // Square
-            return angle < juce::MathConstants<double>::pi ? 1.0 : -1.0;
-        case 3: // Triangle
-            return std::abs (angle / juce::MathConstants<double>::pi - 1.0) * 2.0 - 1.0;
-        default:
-            return 0.0;
+        params.osc1WaveType = snapshot.osc1WaveType;
+        params.osc2WaveType = snapshot.osc2WaveType;
     }
+
+    // A new user waveform means fetching the tables again, like a new wave type
+    if (wavetables.updateUserTable())
+        changes |= VoiceRenderParameters::waveTypesChanged;
+
+    if (snapshot.hasChanged (VoiceRenderParameters::unisonChanged))
+    {
+        params.unisonVoices = snapshot.unisonVoices;
+        params.unisonDetune = snapshot.unisonDetune;
+        params.unisonWidth = snapshot.unisonWidth;
+    }
+
+    if (snapshot.hasChanged (VoiceRenderParameters::panChanged))
+        params.panSpread = snapshot.panSpread;
+
+    // The pool advances these itself while rendering, so they are handed over
+    // every tick, whether or not they moved
+    params.osc1Frequency = snapshot.osc1Frequency;
+    params.osc2Frequency = snapshot.osc2Frequency;
+    params.osc1FrequencyStep = snapshot.osc1FrequencyStep;
+    params.osc2FrequencyStep = snapshot.osc2FrequencyStep;
+    params.mixLevel1 = 1.0f - snapshot.oscMix;
+    params.mixLevel2 = snapshot.oscMix;
+    params.mixLevel1Step = -snapshot.oscMixStep;
+    params.mixLevel2Step = snapshot.oscMixStep;
+
+    if (snapshot.hasChanged (VoiceRenderParameters::modulationChanged))
+        params.modulationRoutes = snapshot.modulationRoutes;
+
+    // Calculate the LFO values, advancing by one tick of the scheduler. The
+    // voice pool routes them per voice; LFO 1 also sweeps the cutoff for all
+    // of them by LFO_DEPTH, and there its right side can run ahead of the left
+    // one, which filters them differently. The phases are normalised like the
+    // oscillators', so wrapping them keeps their float precision the same
+    // however long the LFOs run.
+    const auto lfoWave = static_cast<ModulationMatrix::LfoWave> (snapshot.lfoWaveType);
+    auto lfo = ModulationMatrix::getLfoSample (lfoWave, lfoPhase, accuracy);
+    auto lfoRight = lfo;
+    lfoValue.store (lfo, std::memory_order_relaxed);
+
+    if (snapshot.lfoStereoPhase != 0.0f)
+    {
+        auto phaseRight = lfoPhase + snapshot.lfoStereoPhase / 360.0f;
+        phaseRight -= phaseRight >= 1.0f ? 1.0f : 0.0f;
+        lfoRight = ModulationMatrix::getLfoSample (lfoWave, phaseRight, accuracy);
+    }
+
+    params.lfo1 = lfo;
+    params.lfo2 = ModulationMatrix::getLfoSample (static_cast<ModulationMatrix::LfoWave> (snapshot.lfo2WaveType), lfo2Phase, accuracy);
+
+    const auto tickSeconds = (float) (scheduler.getTickInterval() / sampleRate);
+
+    for (auto [phase, rate] : { std::pair { &lfoPhase, snapshot.lfoRate }, std::pair { &lfo2Phase, snapshot.lfo2Rate } })
+    {
+        *phase += rate * tickSeconds;
+        if (*phase >= 1.0f)
+            *phase -= 1.0f;
+    }
+
+    // Apply LFO modulation to filter cutoff
+    auto modulate = [&snapshot] (float value)
+    {
+        float modulatedCutoff = snapshot.filterCutoff + (value * snapshot.lfoDepth * snapshot.filterCutoff);
+        return std::fmax (FilterControl::minCutoff, std::fmin (FilterControl::maxCutoff, modulatedCutoff));
+    };
+
+    const auto cutoff = modulate (lfo);
+    const auto cutoffRight = modulate (lfoRight);
+    const auto resonance = std::max (FilterControl::minResonance, snapshot.filterResonance);
+
+    if (snapshot.hasChanged (VoiceRenderParameters::filterChanged)
+         || cutoff != params.filterCutoff || cutoffRight != params.filterCutoffRight || resonance != params.filterResonance)
+    {
+        params.filterCutoff = cutoff;
+        params.filterCutoffRight = cutoffRight;
+        params.filterResonance = resonance;
+        params.filterType = snapshot.filterType;
+        changes |= VoiceRenderParameters::filterChanged;
+    }
+
+    params.changes = changes;
+    voicePool.setParameters (params);
 }
 
-void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
-                                              juce::MidiBuffer& midiMessages)
+namespace
 {
+    void addVoices (juce::AudioBuffer<float>& buffer, int channel, int startSample, const float* voices, int numSamples)
+    {
+        buffer.addFrom (channel, startSample, voices, numSamples);
+    }
+
+    void addVoices (juce::AudioBuffer<double>& buffer, int channel, int startSample, const float* voices, int numSamples)
+    {
+        auto* destination = buffer.getWritePointer (channel, startSample);
+
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] += (double) voices[i];
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::renderBlock (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
+{
+    BlockTrace::BlockScope traceScope (blockTrace, buffer.getNumSamples(), midiMessages.getNumEvents());
+    const RealtimeMonitor::AudioScope realtimeScope (realtimeMonitor, buffer.getNumSamples(), sampleRate);
+
+    // Filter states decaying towards zero would otherwise turn denormal and
+    // slow every operation on them down
+    const juce::ScopedNoDenormals noDenormals;
+
     buffer.clear();
 
-    // Handle MIDI events to trigger ADSR, or use 'Always On' mode
-    bool currentAlwaysOnState = static_cast<bool>(masterAlwaysOn->load());
+    // Handle MIDI events to trigger voices, or use 'Always On' mode, which holds
+    // a single voice at the reference note
+    bool currentAlwaysOnState = parameterReader.isAlwaysOn();
     if (currentAlwaysOnState && !previousAlwaysOnState)
     {
-        adsr.noteOn(); // Trigger note on when 'Always On' is activated
+        voicePool.allNotesOff();
+        voicePool.noteOn (SynthVoice::referenceNote, 1.0f);
     }
     else if (!currentAlwaysOnState && previousAlwaysOnState)
     {
-        adsr.noteOff(); // Trigger note off when 'Always On' is deactivated
+        voicePool.noteOff (SynthVoice::referenceNote);
     }
     previousAlwaysOnState = currentAlwaysOnState;
 
-    if (!currentAlwaysOnState)
+    auto onEvent = [this, currentAlwaysOnState] (const juce::MidiMessage& message)
+    {
+        if (!currentAlwaysOnState)
+            handleMidiEvent (message);
+    };
+
+    if (! parameterReader.isMasterEnabled())
     {
         for (const auto metadata : midiMessages)
-        {
-            const auto message = metadata.getMessage();
-            if (message.isNoteOn())
-            {
-                adsr.noteOn();
-            }
-            else if (message.isNoteOff())
-            {
-                adsr.noteOff();
-            }
-        }
+            onEvent (metadata.getMessage());
+
+        traceScope.setSkipped();
+        traceScope.setActiveVoices (voicePool.getNumActiveVoices());
+
+        if (telemetry.isEnabled())
+            telemetry.push (buffer, voicePool.getStatus());
+
+        return;
     }
 
-    auto* masterEnabled = static_cast<juce::AudioParameterBool*> (apvts.getParameter (MASTER_ENABLED));
-    if (!masterEnabled->get())
+    // With nothing sounding and nothing about to start, the block is left as
+    // cleared, clear flag and all, without even ticking the parameters. They
+    // and the filter jump to wherever they are once something plays again.
+    if (voicePool.getNumActiveVoices() == 0 && midiMessages.isEmpty() && presetSwitch.isSettled())
+    {
+        idle = true;
+        traceScope.setSkipped();
+
+        if (telemetry.isEnabled())
+            telemetry.push (buffer, voicePool.getStatus());
+
         return;
+    }
 
-    // Get ADSR parameter values
-    juce::ADSR::Parameters adsrParams;
-    adsrParams.attack = attack->load();
-    adsrParams.decay = decay->load();
-    adsrParams.sustain = sustain->load();
-    adsrParams.release = release->load();
-    adsr.setParameters (adsrParams);
+    if (std::exchange (idle, false))
+    {
+        if (! presetSwitch.isHolding())
+            parameterReader.jumpToCurrentValues();
 
-    auto* osc1Freq = static_cast<juce::AudioParameterFloat*> (apvts.getParameter (OSC1_FREQ));
-    auto* osc2Freq = static_cast<juce::AudioParameterFloat*> (apvts.getParameter (OSC2_FREQ));
-    auto* oscMix = static_cast<juce::AudioParameterFloat*> (apvts.getParameter (OSC_MIX));
+        voicePool.jumpToNextTargets();
+        scheduler.reset (scheduler.getTickInterval());
+    }
 
-    auto osc1AngleDelta = osc1Freq->get() / sampleRate * juce::MathConstants<double>::twoPi;
-    auto osc2AngleDelta = osc2Freq->get() / sampleRate * juce::MathConstants<double>::twoPi;
+    // Events are applied at their own sample position, and parameters and the
+    // LFO are updated on the scheduler's fixed grid. Voices render each span
+    // into a small scratch buffer that was sized in prepareToPlay, in stereo
+    // only while the two sides differ. Voices always render in float, and
+    // are widened on the way into a double precision host buffer.
+    auto* voiceLeft = voiceBuffer.getWritePointer (0);
+    auto* voiceRight = voiceBuffer.getWritePointer (1);
 
-    float mixLevel1 = 1.0f - oscMix->get();
-    float mixLevel2 = oscMix->get();
+    scheduler.process (buffer.getNumSamples(), midiMessages, onEvent,
+                       [this]
+                       {
+                           const BlockTrace::SpanScope traceSpan (&blockTrace, BlockTrace::Stage::parameters);
+                           updateRenderParameters();
+                       },
+                       [this, &buffer, voiceLeft, voiceRight] (int startSample, int numSamples)
+                       {
+                           const auto stereo = buffer.getNumChannels() > 1 && voicePool.isStereo();
 
-    // Calculate LFO value
-    auto lfoValue = std::sin (lfoPhase);
-    lfoPhase += lfoRate->load() / sampleRate * juce::MathConstants<double>::twoPi;
-    if (lfoPhase > juce::MathConstants<double>::twoPi)
-        lfoPhase -= juce::MathConstants<double>::twoPi;
+                           juce::FloatVectorOperations::clear (voiceLeft, numSamples);
 
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-    {
-        auto osc1Sample = AudioPluginAudioProcessor::getOscillatorSample (osc1Angle, static_cast<int> (osc1WaveType->load()));
-        auto osc2Sample = AudioPluginAudioProcessor::getOscillatorSample (osc2Angle, static_cast<int> (osc2WaveType->load()));
+                           if (stereo)
+                               juce::FloatVectorOperations::clear (voiceRight, numSamples);
 
-        auto currentSample = (osc1Sample * mixLevel1 + osc2Sample * mixLevel2) * 0.15f;
+                           voicePool.renderNextBlock (voiceLeft, stereo ? voiceRight : nullptr, numSamples);
 
-        // Apply LFO modulation to filter cutoff
-        float modulatedCutoff = filterCutoff->load() + (lfoValue * lfoDepth->load() * filterCutoff->load());
-        filter.setCutoffFrequency (std::fmax (20.0f, std::fmin (20000.0f, modulatedCutoff)));
-        filter.setResonance (std::max(0.01f, filterResonance->load()));
+                           const BlockTrace::SpanScope traceSpan (&blockTrace, BlockTrace::Stage::output);
 
-        switch (static_cast<int> (filterType->load()))
-        {
-            case 0: filter.setType (juce::dsp::StateVariableTPTFilterType::lowpass); break;
-            case 1: filter.setType (juce::dsp::StateVariableTPTFilterType::bandpass); break;
-            case 2: filter.setType (juce::dsp::StateVariableTPTFilterType::highpass); break;
-        }
+                           for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                               addVoices (buffer, channel, startSample, stereo && channel == 1 ? voiceRight : voiceLeft, numSamples);
 
-        currentSample = filter.processSample (0, currentSample);
+                           presetSwitch.process (buffer, startSample, numSamples);
+                       });
 
-        // Apply ADSR envelope gain
-        currentSample *= adsr.getNextSample();
+    traceScope.setActiveVoices (voicePool.getNumActiveVoices());
 
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-            buffer.addSample (channel, sample, currentSample);
+    if (telemetry.isEnabled())
+        telemetry.push (buffer, voicePool.getStatus());
+}
 
-        osc1Angle += osc1AngleDelta;
-        osc2Angle += osc2AngleDelta;
+void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    renderBlock (buffer, midiMessages);
+}
 
-        if (osc1Angle > juce::MathConstants<double>::twoPi)
-            osc1Angle -= juce::MathConstants<double>::twoPi;
+void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    renderBlock (buffer, midiMessages);
+}
 
-        if (osc2Angle > juce::MathConstants<double>::twoPi)
-            osc2Angle -= juce::MathConstants<double>::twoPi;
-    }
+bool AudioPluginAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::createParameters()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
 
-    params.push_back (std::make_unique<juce::AudioParameterChoice> (OSC1_WAVE, "Oscillator 1 Wave", juce::StringArray { "Sine", "Saw", "Square", "Triangle" }, 0));
-    params.push_back (std::make_unique<juce::AudioParameterChoice> (OSC2_WAVE, "Oscillator 2 Wave", juce::StringArray { "Sine", "Saw", "Square", "Triangle" }, 0));
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (OSC1_WAVE, "Oscillator 1 Wave", juce::StringArray { "Sine", "Saw", "Square", "Triangle", "User" }, 0));
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (OSC2_WAVE, "Oscillator 2 Wave", juce::StringArray { "Sine", "Saw", "Square", "Triangle", "User" }, 0));
 
     params.push_back (std::make_unique<juce::AudioParameterBool>  (MASTER_ENABLED, "Master Enabled", true));
     params.push_back (std::make_unique<juce::AudioParameterFloat> (OSC1_FREQ, "Oscillator 1 Frequency", 50.0f, 2000.0f, 440.0f));
@@ -272,6 +566,34 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
 
     params.push_back (std::make_unique<juce::AudioParameterBool> (MASTER_ALWAYS_ON, "Always On", true));
 
+    // Added after the rest, so hosts that address parameters by index still
+    // find the older ones where they were
+    params.push_back (std::make_unique<juce::AudioParameterInt>   (UNISON_VOICES, "Unison Voices", 1, VoiceLanes::maxUnison, 1));
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (UNISON_DETUNE, "Unison Detune", juce::NormalisableRange<float> (0.0f, 100.0f), 20.0f, juce::String ("ct"), juce::AudioProcessorParameter::genericParameter, [](float value, int /*maximumStringLength*/) { return juce::String (value, 1); }, [](const juce::String& text) { return text.getFloatValue(); }));
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (UNISON_WIDTH, "Unison Width", 0.0f, 1.0f, 0.5f));
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (PAN_SPREAD, "Pan Spread", 0.0f, 1.0f, 0.0f));
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (LFO_STEREO_PHASE, "LFO Stereo Phase", juce::NormalisableRange<float> (0.0f, 180.0f), 0.0f, juce::String ("deg"), juce::AudioProcessorParameter::genericParameter, [](float value, int /*maximumStringLength*/) { return juce::String (static_cast<int> (value)); }, [](const juce::String& text) { return text.getFloatValue(); }));
+
+    const juce::StringArray lfoWaves { "Sine", "Saw", "Square", "Triangle" };
+
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (LFO_WAVE, "LFO Wave", lfoWaves, 0));
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (LFO2_RATE, "LFO 2 Rate", juce::NormalisableRange<float> (0.01f, 20.0f, 0.0f, 0.5f), 2.0f, juce::String ("Hz"), juce::AudioProcessorParameter::genericParameter, [](float value, int /*maximumStringLength*/) { return juce::String (value, 2); }, [](const juce::String& text) { return text.getFloatValue(); }));
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (LFO2_WAVE, "LFO 2 Wave", lfoWaves, 0));
+
+    for (size_t route = 0; route < (size_t) ModulationMatrix::maxRoutes; ++route)
+    {
+        const auto name = "Mod " + juce::String ((int) route + 1);
+
+        params.push_back (std::make_unique<juce::AudioParameterChoice> (MOD_SOURCE[route], name + " Source", juce::StringArray { "None", "LFO 1", "LFO 2", "Envelope", "Velocity" }, 0));
+        params.push_back (std::make_unique<juce::AudioParameterChoice> (MOD_DESTINATION[route], name + " Destination", juce::StringArray { "Pitch", "Mix", "Cutoff", "Resonance" }, 2));
+        params.push_back (std::make_unique<juce::AudioParameterFloat> (MOD_DEPTH[route], name + " Depth", -1.0f, 1.0f, 0.0f));
+    }
+
+    // Saved with the session but not automatable, as the worker threads are
+    // only started when the host prepares the plugin
+    params.push_back (std::make_unique<juce::AudioParameterInt> (juce::ParameterID { VOICE_THREADS }, "Voice Threads", 0, maxVoiceThreads, 0,
+                                                                 juce::AudioParameterIntAttributes().withAutomatable (false)));
+
     return { params.begin(), params.end() };
 }
 
@@ -290,17 +612,75 @@ juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
 //==============================================================================
 void AudioPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    juce::ignoreUnused (destData);
+    std::vector<float> values ((size_t) presetLayout.getNumParameters());
+    presetLayout.getCurrentValues (values.data());
+
+    BinaryState::write (presetLayout, values.data(), currentProgram, wavetables.getUserWaveform(), destData);
 }
 
 void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    juce::ignoreUnused (data, sizeInBytes);
+    std::vector<float> values ((size_t) presetLayout.getNumParameters());
+    std::vector<float> userWaveform;
+    int program = 0;
+
+    if (! BinaryState::read (presetLayout, data, (size_t) juce::jmax (0, sizeInBytes), values.data(), program, userWaveform))
+        return;
+
+    currentProgram = program;
+    applyPresetValues (values.data());
+
+    // A state without a user waveform goes back to the default one
+    if (userWaveform != wavetables.getUserWaveform())
+        wavetables.setUserWaveform (userWaveform.data(), (int) userWaveform.size());
+}
+
+//==============================================================================
+bool AudioPluginAudioProcessor::loadUserWaveform (const juce::File& file)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+    // A single cycle is short, anything longer than the table is not one
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->lengthInSamples > Wavetable::tableSize * 4)
+        return false;
+
+    juce::AudioBuffer<float> cycle (1, static_cast<int> (reader->lengthInSamples));
+    reader->read (&cycle, 0, cycle.getNumSamples(), 0, true, false);
+
+    wavetables.setUserWaveform (cycle.getReadPointer (0), cycle.getNumSamples());
+    return true;
+}
+
+void AudioPluginAudioProcessor::clearUserWaveform()
+{
+    wavetables.setUserWaveform (nullptr, 0);
+}
+
+//==============================================================================
+juce::File AudioPluginAudioProcessor::writeRealtimeReport()
+{
+    const auto report = juce::Time::getCurrentTime().toString (true, true) + "\n"
+                       + realtimeMonitor.getSnapshot().toString() + "\n\n";
+
+    juce::Logger::writeToLog (report);
+
+    auto file = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                    .getChildFile (juce::String (JucePlugin_Name) + " Realtime Report.txt");
+    file.appendText (report);
+    return file;
+}
+
+juce::File AudioPluginAudioProcessor::writeBlockTrace()
+{
+    auto file = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                    .getChildFile (juce::String (JucePlugin_Name) + " Trace " + juce::Time::getCurrentTime().formatted ("%Y-%m-%d %H-%M-%S") + ".json");
+
+    const auto result = blockTrace.writeChromeTrace (file);
+    juce::Logger::writeToLog (result.wasOk() ? "Block trace written to " + file.getFullPathName() : result.getErrorMessage());
+    return file;
 }
 
 //==============================================================================
@@ -3,6 +3,15 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include "AudioTelemetry.h"
+#include "BlockTrace.h"
+#include "ParameterSnapshot.h"
+#include "PresetBank.h"
+#include "RealtimeMonitor.h"
+#include "SubBlockScheduler.h"
+#include "SynthVoice.h"
+#include "WavetableBank.h"
+
 //==============================================================================
 class AudioPluginAudioProcessor final : public juce::AudioProcessor
 {
@@ -18,7 +27,8 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -43,6 +53,61 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    /** The bank the programs come from, shared by every instance. Each
+        rewrite of the bank goes to a new file, see PresetBank.
+    */
+    static juce::File getPresetBankFile();
+
+    /** Appends the current settings to the preset bank and makes them the
+        current program. Call from the message thread.
+    */
+    juce::Result addPreset (const juce::String& name);
+
+    //==============================================================================
+    /** Loads one cycle of a waveform from an audio file into the "User" wave
+        slot of both oscillators. Call from the message thread.
+    */
+    bool loadUserWaveform (const juce::File& file);
+
+    /** Puts the default sine back into the "User" wave slot. */
+    void clearUserWaveform();
+
+    /** Spreads voice rendering over this many worker threads besides the audio
+        thread, 0 to render on the audio thread alone. This is the VOICE_THREADS
+        setting, and takes effect on the next prepareToPlay.
+    */
+    void setNumVoiceThreads (int numWorkers);
+    int getNumVoiceThreads() const;
+
+    /** The output and voice status as it leaves processBlock, for display.
+        Only filled while something has enabled it.
+    */
+    TelemetryChannel& getTelemetry()            { return telemetry; }
+
+    /** LFO 1's output on the left side, -1 to 1, as of the last parameter
+        tick, for display. It holds still while the processor is idle. Any thread.
+    */
+    float getLfoValue() const noexcept          { return lfoValue.load (std::memory_order_relaxed); }
+
+    /** Allocation, lock and deadline statistics of processBlock. These are only
+        gathered in builds with NEUTRON_REALTIME_CHECKS enabled.
+    */
+    RealtimeMonitor& getRealtimeMonitor()       { return realtimeMonitor; }
+
+    /** The recent blocks' timings, recorded all the time. */
+    BlockTrace& getBlockTrace()                 { return blockTrace; }
+
+    /** Writes the block trace as Chrome trace JSON into the user's documents
+        folder, and returns the file.
+    */
+    juce::File writeBlockTrace();
+
+    /** Appends the current real-time statistics to a report file in the user's
+        documents folder, and to the log. Returns the file.
+    */
+    juce::File writeRealtimeReport();
+
     juce::AudioProcessorValueTreeState apvts;
 
     static const juce::String OSC1_WAVE;
@@ -51,6 +116,10 @@ public:
     static const juce::String OSC1_FREQ;
     static const juce::String OSC2_FREQ;
     static const juce::String OSC_MIX;
+    static const juce::String UNISON_VOICES;
+    static const juce::String UNISON_DETUNE;
+    static const juce::String UNISON_WIDTH;
+    static const juce::String PAN_SPREAD;
     static const juce::String FILTER_TYPE;
     static const juce::String FILTER_CUTOFF;
     static const juce::String FILTER_RESONANCE;
@@ -60,39 +129,61 @@ public:
     static const juce::String RELEASE;
     static const juce::String LFO_RATE;
     static const juce::String LFO_DEPTH;
+    static const juce::String LFO_STEREO_PHASE;
     static const juce::String MASTER_ALWAYS_ON;
+    static const juce::String LFO_WAVE;
+    static const juce::String LFO2_RATE;
+    static const juce::String LFO2_WAVE;
+    static const juce::String VOICE_THREADS;
+
+    // One of each per modulation matrix route
+    static const std::array<juce::String, ModulationMatrix::maxRoutes> MOD_SOURCE;
+    static const std::array<juce::String, ModulationMatrix::maxRoutes> MOD_DESTINATION;
+    static const std::array<juce::String, ModulationMatrix::maxRoutes> MOD_DEPTH;
 
 private:
+    static constexpr int realtimeControlInterval = SubBlockScheduler::defaultTickInterval;
+    static constexpr int offlineControlInterval = 8;
+    static constexpr int maxVoiceThreads = 3;
+
     double sampleRate = 0.0;
-    double osc1Angle = 0.0;
-    double osc2Angle = 0.0;
-    double lfoPhase = 0.0;
-    
-    std::atomic<float>* osc1WaveType = nullptr;
-    std::atomic<float>* osc2WaveType = nullptr;
-    
-    juce::dsp::StateVariableTPTFilter<float> filter;
-    
-    std::atomic<float>* filterType = nullptr;
-    std::atomic<float>* filterCutoff = nullptr;
-    std::atomic<float>* filterResonance = nullptr;
-
-    juce::ADSR adsr;
-    std::atomic<float>* attack = nullptr;
-    std::atomic<float>* decay = nullptr;
-    std::atomic<float>* sustain = nullptr;
-    std::atomic<float>* release = nullptr;
-
-    std::atomic<float>* lfoRate = nullptr;
-    std::atomic<float>* lfoDepth = nullptr;
-
-    std::atomic<float>* masterAlwaysOn = nullptr;
+    float lfoPhase = 0.0f;      // normalised, [0, 1)
+    float lfo2Phase = 0.0f;
+    std::atomic<float> lfoValue { 0.0f };
+    FastMath::Accuracy accuracy = FastMath::Accuracy::draft;
+
+    WavetableBank wavetables;
+    VoicePool voicePool;
+    VoiceThreadPool voiceThreads;
+    SubBlockScheduler scheduler;
+    VoiceRenderParameters renderParameters;
+    juce::AudioBuffer<float> voiceBuffer;
+    RealtimeMonitor realtimeMonitor;
+    BlockTrace blockTrace;
+    TelemetryChannel telemetry;
+    ParameterReader parameterReader { apvts };
+
+    PresetLayout presetLayout { *this };
+    std::shared_ptr<const PresetBank> presetBank;
+    juce::SpinLock presetBankLock;
+    PresetSwitch presetSwitch;
+    int currentProgram = 0;
 
     bool previousAlwaysOnState = false;
+    bool idle = false;      // the last block was skipped because nothing was sounding
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
 
-    static double getOscillatorSample (double angle, int waveType);
+    template <typename SampleType>
+    void renderBlock (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+
+    void handleMidiEvent (const juce::MidiMessage& message);
+    void updateRenderParameters();
+
+    void applyPresetValues (const float* values);
+    static juce::File getPresetIndexFile();
+    std::shared_ptr<const PresetBank> getPresetBank() const;
+    juce::Result rewritePresetBank (const std::function<void (std::vector<PresetBank::Preset>&)>& edit);
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
 };
@@ -0,0 +1,328 @@
+#include "PresetBank.h"
+
+namespace
+{
+    constexpr char stateMagic[4] = { 'N', 'T', 's', 't' };
+    constexpr char bankMagic[4] = { 'N', 'T', 'b', 'k' };
+
+    constexpr juce::uint16 stateVersion = 2;
+    constexpr juce::uint16 bankVersion = 1;
+
+    constexpr size_t stateHeaderSize = 12;      // magic, version, number of values, program
+    constexpr size_t bankHeaderSize = 16;       // magic, version, number of columns, presets, record size
+
+    float readFloat (const void* data) noexcept
+    {
+        const auto bits = juce::ByteOrder::littleEndianInt (data);
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+}
+
+//==============================================================================
+PresetLayout::PresetLayout (juce::AudioProcessor& processor)
+{
+    for (auto* parameter : processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+        {
+            sortedKeys.emplace_back (makeKey (ranged->getParameterID()), parameters.size());
+            keys.push_back (sortedKeys.back().first);
+            parameters.add (ranged);
+        }
+    }
+
+    std::sort (sortedKeys.begin(), sortedKeys.end());
+
+    // Two IDs hashing alike would make one of them unloadable
+    jassert (std::adjacent_find (sortedKeys.begin(), sortedKeys.end(),
+                                 [] (auto& a, auto& b) { return a.first == b.first; }) == sortedKeys.end());
+}
+
+int PresetLayout::indexOf (juce::uint32 key) const noexcept
+{
+    const auto found = std::lower_bound (sortedKeys.begin(), sortedKeys.end(), std::pair<juce::uint32, int> { key, 0 });
+    return found != sortedKeys.end() && found->first == key ? found->second : -1;
+}
+
+void PresetLayout::getDefaultValues (float* values) const
+{
+    for (int i = 0; i < parameters.size(); ++i)
+        values[i] = parameters[i]->convertFrom0to1 (parameters[i]->getDefaultValue());
+}
+
+void PresetLayout::getCurrentValues (float* values) const
+{
+    for (int i = 0; i < parameters.size(); ++i)
+        values[i] = parameters[i]->convertFrom0to1 (parameters[i]->getValue());
+}
+
+void PresetLayout::setValues (const float* values) const
+{
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        const auto normalised = parameters[i]->convertTo0to1 (values[i]);
+
+        if (normalised != parameters[i]->getValue())
+            parameters[i]->setValueNotifyingHost (normalised);
+    }
+}
+
+juce::uint32 PresetLayout::makeKey (const juce::String& parameterID) noexcept
+{
+    // FNV-1a over the UTF-8 bytes, which stays the same across platforms and
+    // JUCE versions, unlike String::hashCode()
+    juce::uint32 hash = 2166136261u;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+        hash = (hash ^ (juce::uint8) *c) * 16777619u;
+
+    return hash;
+}
+
+//==============================================================================
+void BinaryState::write (const PresetLayout& layout, const float* values, int program,
+                         const std::vector<float>& userWaveform, juce::MemoryBlock& destData)
+{
+    const auto numValues = layout.getNumParameters();
+
+    destData.reset();
+    destData.ensureSize (stateHeaderSize + (size_t) numValues * 8 + 4 + userWaveform.size() * 4);
+
+    juce::MemoryOutputStream stream (destData, false);
+    stream.write (stateMagic, sizeof (stateMagic));
+    stream.writeShort ((short) stateVersion);
+    stream.writeShort ((short) numValues);
+    stream.writeInt (program);
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        stream.writeInt ((int) layout.getKey (i));
+        stream.writeFloat (values[i]);
+    }
+
+    stream.writeInt ((int) userWaveform.size());
+
+    for (auto sample : userWaveform)
+        stream.writeFloat (sample);
+}
+
+bool BinaryState::read (const PresetLayout& layout, const void* data, size_t size, float* values, int& program,
+                        std::vector<float>& userWaveform)
+{
+    auto* bytes = static_cast<const juce::uint8*> (data);
+
+    if (bytes == nullptr || size < stateHeaderSize || std::memcmp (bytes, stateMagic, sizeof (stateMagic)) != 0)
+        return false;
+
+    const auto version = juce::ByteOrder::littleEndianShort (bytes + 4);
+    const auto numValues = (size_t) juce::ByteOrder::littleEndianShort (bytes + 6);
+
+    if (version > stateVersion || size < stateHeaderSize + numValues * 8)
+        return false;
+
+    const auto* waveform = bytes + stateHeaderSize + numValues * 8;
+    size_t numSamples = 0;
+
+    if (version >= 2)
+    {
+        if (size < stateHeaderSize + numValues * 8 + 4)
+            return false;
+
+        numSamples = (size_t) juce::ByteOrder::littleEndianInt (waveform);
+        waveform += 4;
+
+        if ((size_t) (bytes + size - waveform) / 4 < numSamples)
+            return false;
+    }
+
+    layout.getDefaultValues (values);
+    program = (int) juce::ByteOrder::littleEndianInt (bytes + 8);
+
+    for (auto* pair = bytes + stateHeaderSize; pair < bytes + stateHeaderSize + numValues * 8; pair += 8)
+        if (const auto index = layout.indexOf (juce::ByteOrder::littleEndianInt (pair)); index >= 0)
+            values[index] = readFloat (pair + 4);
+
+    userWaveform.resize (numSamples);
+
+    for (size_t i = 0; i < numSamples; ++i)
+        userWaveform[i] = readFloat (waveform + i * 4);
+
+    return true;
+}
+
+//==============================================================================
+bool PresetBank::open (const juce::File& file, const PresetLayout& newLayout)
+{
+    close();
+
+    if (! file.existsAsFile())
+        return false;
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+    auto* bytes = static_cast<const juce::uint8*> (mapped->getData());
+    const auto size = mapped->getSize();
+
+    if (bytes == nullptr || size < bankHeaderSize || std::memcmp (bytes, bankMagic, sizeof (bankMagic)) != 0
+         || juce::ByteOrder::littleEndianShort (bytes + 4) > bankVersion)
+        return false;
+
+    const auto numColumns = (size_t) juce::ByteOrder::littleEndianShort (bytes + 6);
+    const auto presets = (size_t) juce::ByteOrder::littleEndianInt (bytes + 8);
+    const auto record = (size_t) juce::ByteOrder::littleEndianInt (bytes + 12);
+    const auto offset = bankHeaderSize + numColumns * 4;
+
+    if (record < maxNameBytes + numColumns * 4 || size < offset || (size - offset) / record < presets
+         || presets > (size_t) std::numeric_limits<int>::max())
+        return false;
+
+    columnParameters.resize (numColumns);
+
+    for (size_t column = 0; column < numColumns; ++column)
+        columnParameters[column] = newLayout.indexOf (juce::ByteOrder::littleEndianInt (bytes + bankHeaderSize + column * 4));
+
+    mappedFile = std::move (mapped);
+    layout = &newLayout;
+    numPresets = (int) presets;
+    recordsOffset = offset;
+    recordSize = record;
+    return true;
+}
+
+void PresetBank::close()
+{
+    mappedFile.reset();
+    layout = nullptr;
+    numPresets = 0;
+    columnParameters.clear();
+}
+
+const juce::uint8* PresetBank::getRecord (int index) const noexcept
+{
+    if (! juce::isPositiveAndBelow (index, numPresets))
+        return nullptr;
+
+    return static_cast<const juce::uint8*> (mappedFile->getData()) + recordsOffset + (size_t) index * recordSize;
+}
+
+juce::String PresetBank::getName (int index) const
+{
+    if (auto* record = getRecord (index))
+    {
+        const auto* name = reinterpret_cast<const char*> (record);
+        return juce::String::fromUTF8 (name, (int) (std::find (name, name + maxNameBytes, 0) - name));
+    }
+
+    return {};
+}
+
+bool PresetBank::getValues (int index, float* values) const
+{
+    auto* record = getRecord (index);
+
+    if (record == nullptr)
+        return false;
+
+    layout->getDefaultValues (values);
+
+    for (size_t column = 0; column < columnParameters.size(); ++column)
+        if (columnParameters[column] >= 0)
+            values[columnParameters[column]] = readFloat (record + maxNameBytes + column * 4);
+
+    return true;
+}
+
+PresetBank::Preset PresetBank::getPreset (int index) const
+{
+    Preset preset;
+
+    if (layout != nullptr)
+    {
+        preset.name = getName (index);
+        preset.values.resize ((size_t) layout->getNumParameters());
+        getValues (index, preset.values.data());
+    }
+
+    return preset;
+}
+
+juce::File PresetBank::getCurrentFile (const juce::File& indexFile)
+{
+    const auto name = indexFile.loadFileAsString().trim();
+
+    // Before there was an index, the bank lived under the same name
+    return name.isEmpty() ? indexFile.withFileExtension ("bank") : indexFile.getSiblingFile (name);
+}
+
+juce::Result PresetBank::write (const juce::File& indexFile, const PresetLayout& layout, const std::vector<Preset>& presets)
+{
+    const auto numColumns = layout.getNumParameters();
+
+    juce::MemoryBlock data;
+    juce::MemoryOutputStream stream (data, false);
+
+    stream.write (bankMagic, sizeof (bankMagic));
+    stream.writeShort ((short) bankVersion);
+    stream.writeShort ((short) numColumns);
+    stream.writeInt ((int) presets.size());
+    stream.writeInt (maxNameBytes + numColumns * 4);
+
+    for (int i = 0; i < numColumns; ++i)
+        stream.writeInt ((int) layout.getKey (i));
+
+    for (const auto& preset : presets)
+    {
+        jassert ((int) preset.values.size() == numColumns);
+
+        // Names are cut to whole characters that fit, zero padded
+        auto name = preset.name;
+
+        while (name.getNumBytesAsUTF8() > (size_t) maxNameBytes)
+            name = name.dropLastCharacters (1);
+
+        char nameBytes[maxNameBytes] = {};
+        std::memcpy (nameBytes, name.toRawUTF8(), name.getNumBytesAsUTF8());
+        stream.write (nameBytes, sizeof (nameBytes));
+
+        for (int i = 0; i < numColumns; ++i)
+            stream.writeFloat (i < (int) preset.values.size() ? preset.values[(size_t) i] : 0.0f);
+    }
+
+    stream.flush();
+
+    // Generations are numbered after the index, Presets-1.bank, Presets-2.bank
+    // and so on. A file left behind by a write that never reached the index
+    // is skipped rather than overwritten.
+    const auto baseName = indexFile.getFileNameWithoutExtension() + "-";
+    const auto previous = getCurrentFile (indexFile);
+    auto generation = previous.getFileNameWithoutExtension().fromLastOccurrenceOf ("-", false, false).getIntValue();
+    juce::File next;
+
+    do
+    {
+        next = indexFile.getSiblingFile (baseName + juce::String (++generation) + ".bank");
+    }
+    while (next.exists());
+
+    // Nobody reads the new file until the index names it, and the index is
+    // only ever read whole, never mapped, so it can always be replaced
+    if (! next.replaceWithData (data.getData(), data.getSize()) || ! indexFile.replaceWithText (next.getFileName()))
+    {
+        next.deleteFile();
+        return juce::Result::fail ("Couldn't write preset bank: " + next.getFullPathName());
+    }
+
+    // Older generations go once nobody has them mapped. On Windows deleting
+    // one that is still mapped fails, and a later write tries again. The one
+    // just replaced is kept a while longer for instances that read the index
+    // a moment ago and are about to open it.
+    auto stale = indexFile.getParentDirectory().findChildFiles (juce::File::findFiles, false, baseName + "*.bank");
+    stale.add (indexFile.withFileExtension ("bank"));
+
+    for (const auto& old : stale)
+        if (old != next && old != previous)
+            old.deleteFile();
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+//==============================================================================
+/** How presets and saved state refer to the processor's parameters.
+
+    Values are stored plain (not normalised) and keyed by a hash of the
+    parameter ID, so parameters can be added, removed or reordered without
+    breaking what was saved before. Anything a preset doesn't mention keeps
+    its default. In memory, values are kept in the processor's parameter order.
+*/
+class PresetLayout
+{
+public:
+    explicit PresetLayout (juce::AudioProcessor& processor);
+
+    int getNumParameters() const noexcept               { return parameters.size(); }
+    juce::uint32 getKey (int index) const noexcept      { return keys[(size_t) index]; }
+
+    /** Returns -1 for keys of parameters this version doesn't have. */
+    int indexOf (juce::uint32 key) const noexcept;
+
+    void getDefaultValues (float* values) const;
+    void getCurrentValues (float* values) const;
+
+    /** Sets every parameter that differs, notifying the host. */
+    void setValues (const float* values) const;
+
+    static juce::uint32 makeKey (const juce::String& parameterID) noexcept;
+
+private:
+    juce::Array<juce::RangedAudioParameter*> parameters;
+    std::vector<juce::uint32> keys;
+    std::vector<std::pair<juce::uint32, int>> sortedKeys;
+};
+
+//==============================================================================
+/** The plugin state as getStateInformation() writes it: a small header, one
+    key/value pair per parameter, then the user waveform's sample count and
+    samples (since version 2), all little-endian.
+*/
+namespace BinaryState
+{
+    void write (const PresetLayout& layout, const float* values, int program,
+                const std::vector<float>& userWaveform, juce::MemoryBlock& destData);
+
+    /** Fills values, starting from the defaults, and userWaveform, which is
+        left empty for a state without one. Fails on anything that isn't a
+        state this or an earlier version wrote, leaving both untouched.
+    */
+    bool read (const PresetLayout& layout, const void* data, size_t size, float* values, int& program,
+               std::vector<float>& userWaveform);
+}
+
+//==============================================================================
+/** A file of presets that is mapped into memory rather than parsed.
+
+    Presets are fixed-size records after a header and the table of parameter
+    keys, so looking one up is a pointer offset, however many the file holds.
+    Only the pages of presets that are actually used are ever read from disk.
+
+    A bank file is never changed once written. Other instances may have it
+    mapped, and on Windows a mapped file can't be replaced or deleted, so
+    write() puts each new generation in a file of its own and switches a small
+    index file over to it.
+*/
+class PresetBank
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        std::vector<float> values;     // in layout order
+    };
+
+    static constexpr int maxNameBytes = 32;
+
+    /** Maps the file, replacing whatever bank was open. A missing or invalid
+        file leaves the bank empty.
+    */
+    bool open (const juce::File& file, const PresetLayout& layout);
+    void close();
+
+    int getNumPresets() const noexcept      { return numPresets; }
+
+    juce::String getName (int index) const;
+
+    /** Fills values with the preset's, starting from the defaults. */
+    bool getValues (int index, float* values) const;
+
+    Preset getPreset (int index) const;
+
+    /** The bank file the index file currently points to. */
+    static juce::File getCurrentFile (const juce::File& indexFile);
+
+    /** Writes the presets as the next generation of the bank and points the
+        index file at it. Call with other writers of the same index locked out.
+    */
+    static juce::Result write (const juce::File& indexFile, const PresetLayout& layout, const std::vector<Preset>& presets);
+
+private:
+    const juce::uint8* getRecord (int index) const noexcept;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const PresetLayout* layout = nullptr;
+
+    int numPresets = 0;
+    size_t recordsOffset = 0, recordSize = 0;
+
+    // For each column of the file, the layout index it belongs to or -1
+    std::vector<int> columnParameters;
+};
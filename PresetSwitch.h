@@ -0,0 +1,112 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+/** Hands whole-patch changes (programs, restored state) from the message thread
+    to the audio thread without locks, and hides the jump behind a short fade.
+
+    The message thread brackets its parameter writes with beginChange() and
+    endChange(). As soon as a change has begun, the audio thread holds on to
+    the parameter values it had and fades its output out. Once the fade is
+    down and the change is complete, it picks up all new values at once and
+    fades back in. A host never hears a patch that is half old and half new.
+*/
+class PresetSwitch
+{
+public:
+    //==============================================================================
+    /** Message thread. Calls may be repeated before the audio thread gets to
+        them; it only ever switches to the latest patch.
+    */
+    void beginChange() noexcept     { requested.fetch_add (1); }
+    void endChange() noexcept       { completed.store (requested.load()); }
+
+    //==============================================================================
+    /** Audio thread. Forgets about the fade, anything already requested counts
+        as applied.
+    */
+    void prepare (double sampleRate) noexcept
+    {
+        fadeStep = 1.0f / (float) juce::jmax (1.0, sampleRate * fadeSeconds);
+        applied = completed.load();
+        stage = Stage::playing;
+        gain = 1.0f;
+    }
+
+    /** True while the audio thread should keep using the parameter values it
+        had before the change began. Check this after reading parameters.
+    */
+    bool isHolding() const noexcept     { return requested.load() != applied; }
+
+    /** True when no change is pending and no fade is going on. */
+    bool isSettled() const noexcept     { return stage == Stage::playing && ! isHolding(); }
+
+    /** Call at each control tick before reading parameters. Returns true when
+        they should be taken over as they are, without smoothing, because the
+        output just went quiet for a new patch.
+    */
+    bool beginTick() noexcept
+    {
+        if (stage == Stage::waiting)
+        {
+            const auto latest = completed.load();
+
+            if (latest != requested.load())
+                return false;
+
+            applied = latest;
+            stage = Stage::fadingIn;
+            return true;
+        }
+
+        if (isHolding())
+            stage = Stage::fadingOut;
+
+        return false;
+    }
+
+    /** Applies the fade to a span of output. Free while no change is going on. */
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples) noexcept
+    {
+        if (stage == Stage::playing)
+            return;
+
+        const auto target = stage == Stage::fadingIn ? 1.0f : 0.0f;
+        const auto step = target > gain ? fadeStep : -fadeStep;
+        const auto samplesToTarget = juce::jmin (numSamples, (int) std::ceil (std::abs (target - gain) / fadeStep));
+        const auto endGain = samplesToTarget < numSamples ? target : juce::jlimit (0.0f, 1.0f, gain + step * (float) samplesToTarget);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            buffer.applyGainRamp (channel, startSample, samplesToTarget, (SampleType) gain, (SampleType) endGain);
+
+            if (target == 0.0f)
+                buffer.clear (channel, startSample + samplesToTarget, numSamples - samplesToTarget);
+        }
+
+        gain = endGain;
+
+        if (gain == target)
+            stage = target == 0.0f ? Stage::waiting : Stage::playing;
+    }
+
+private:
+    enum class Stage
+    {
+        playing,
+        fadingOut,
+        waiting,    // silent until the change is complete and the next tick picks it up
+        fadingIn
+    };
+
+    static constexpr double fadeSeconds = 0.005;
+
+    std::atomic<juce::uint32> requested { 0 }, completed { 0 };
+
+    juce::uint32 applied = 0;
+    Stage stage = Stage::playing;
+    float gain = 1.0f;
+    float fadeStep = 1.0f;
+};
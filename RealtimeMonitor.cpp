@@ -0,0 +1,256 @@
+#include "RealtimeMonitor.h"
+
+#if NEUTRON_REALTIME_CHECKS
+ #include <cstdlib>
+ #include <new>
+
+ #if JUCE_LINUX
+  #include <dlfcn.h>
+  #include <pthread.h>
+ #elif JUCE_WINDOWS
+  #include <malloc.h>
+ #endif
+
+namespace
+{
+    // Constant-initialised and initial-exec, so reading it never allocates or
+    // locks, which matters when it's read from inside the hooks themselves
+   #if JUCE_GCC || JUCE_CLANG
+    thread_local RealtimeMonitor* currentMonitor __attribute__ ((tls_model ("initial-exec"))) = nullptr;
+   #else
+    thread_local RealtimeMonitor* currentMonitor = nullptr;
+   #endif
+
+   #if JUCE_LINUX
+    // Looked up on first use, by whichever threads get there at the same time
+    std::atomic<int (*) (pthread_mutex_t*)> realMutexLock { nullptr };
+   #endif
+
+    void* allocate (std::size_t size)
+    {
+        RealtimeMonitor::noteAllocation();
+        return std::malloc (size == 0 ? 1 : size);
+    }
+
+    void* allocateAligned (std::size_t size, std::align_val_t alignment)
+    {
+        RealtimeMonitor::noteAllocation();
+        const auto align = juce::jmax (sizeof (void*), static_cast<std::size_t> (alignment));
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc (size == 0 ? 1 : size, align);
+       #else
+        void* result = nullptr;
+        return posix_memalign (&result, align, size == 0 ? 1 : size) == 0 ? result : nullptr;
+       #endif
+    }
+
+    void deallocate (void* p) noexcept
+    {
+        if (p != nullptr)
+            RealtimeMonitor::noteDeallocation();
+
+        std::free (p);
+    }
+
+    void deallocateAligned (void* p) noexcept
+    {
+        if (p != nullptr)
+            RealtimeMonitor::noteDeallocation();
+
+       #if JUCE_WINDOWS
+        _aligned_free (p);
+       #else
+        std::free (p);
+       #endif
+    }
+}
+
+//==============================================================================
+void* operator new (std::size_t size)
+{
+    if (auto* p = allocate (size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    return operator new (size);
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept        { return allocate (size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept      { return allocate (size); }
+
+void* operator new (std::size_t size, std::align_val_t alignment)
+{
+    if (auto* p = allocateAligned (size, alignment))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size, std::align_val_t alignment)
+{
+    return operator new (size, alignment);
+}
+
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept     { return allocateAligned (size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept   { return allocateAligned (size, alignment); }
+
+void operator delete (void* p) noexcept                                                     { deallocate (p); }
+void operator delete[] (void* p) noexcept                                                   { deallocate (p); }
+void operator delete (void* p, std::size_t) noexcept                                        { deallocate (p); }
+void operator delete[] (void* p, std::size_t) noexcept                                      { deallocate (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept                              { deallocate (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept                            { deallocate (p); }
+void operator delete (void* p, std::align_val_t) noexcept                                   { deallocateAligned (p); }
+void operator delete[] (void* p, std::align_val_t) noexcept                                 { deallocateAligned (p); }
+void operator delete (void* p, std::size_t, std::align_val_t) noexcept                      { deallocateAligned (p); }
+void operator delete[] (void* p, std::size_t, std::align_val_t) noexcept                    { deallocateAligned (p); }
+void operator delete (void* p, std::align_val_t, const std::nothrow_t&) noexcept            { deallocateAligned (p); }
+void operator delete[] (void* p, std::align_val_t, const std::nothrow_t&) noexcept          { deallocateAligned (p); }
+
+//==============================================================================
+ #if JUCE_LINUX
+extern "C" int pthread_mutex_lock (pthread_mutex_t* mutex) noexcept
+{
+    using LockFunction = int (*) (pthread_mutex_t*);
+    auto realLock = realMutexLock.load (std::memory_order_acquire);
+
+    if (realLock == nullptr)
+    {
+        realLock = reinterpret_cast<LockFunction> (dlsym (RTLD_NEXT, "pthread_mutex_lock"));
+        realMutexLock.store (realLock, std::memory_order_release);
+    }
+
+    RealtimeMonitor::noteLockAcquired();
+    return realLock (mutex);
+}
+ #endif
+
+//==============================================================================
+void RealtimeMonitor::noteAllocation() noexcept
+{
+    if (auto* monitor = currentMonitor)
+        monitor->allocations.fetch_add (1, std::memory_order_relaxed);
+}
+
+void RealtimeMonitor::noteDeallocation() noexcept
+{
+    if (auto* monitor = currentMonitor)
+        monitor->deallocations.fetch_add (1, std::memory_order_relaxed);
+}
+
+void RealtimeMonitor::noteLockAcquired() noexcept
+{
+    if (auto* monitor = currentMonitor)
+        monitor->lockAcquisitions.fetch_add (1, std::memory_order_relaxed);
+}
+
+RealtimeMonitor* RealtimeMonitor::getCurrent() noexcept
+{
+    return currentMonitor;
+}
+
+RealtimeMonitor::AudioScope::AudioScope (RealtimeMonitor& m, int numSamples, double sampleRate)
+    : monitor (m),
+      previous (currentMonitor),
+      violationsBefore (m.getNumViolations()),
+      deadlineSeconds (sampleRate > 0.0 ? numSamples / sampleRate : 0.0),
+      startTicks (juce::Time::getHighResolutionTicks())
+{
+    currentMonitor = &monitor;
+}
+
+RealtimeMonitor::AudioScope::~AudioScope()
+{
+    const auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    currentMonitor = previous;
+
+    // Only the audio thread writes these, so plain load/store pairs are enough
+    if (deadlineSeconds > 0.0)
+    {
+        const auto load = elapsed / deadlineSeconds;
+
+        if (load > 1.0)
+            monitor.deadlineMisses.fetch_add (1, std::memory_order_relaxed);
+
+        monitor.totalLoad.store (monitor.totalLoad.load (std::memory_order_relaxed) + load, std::memory_order_relaxed);
+
+        if (load > monitor.worstLoad.load (std::memory_order_relaxed))
+            monitor.worstLoad.store (load, std::memory_order_relaxed);
+    }
+
+    if (monitor.getNumViolations() != violationsBefore)
+        monitor.blocksWithViolations.fetch_add (1, std::memory_order_relaxed);
+
+    monitor.blocks.fetch_add (1, std::memory_order_release);
+}
+
+RealtimeMonitor::WorkerScope::WorkerScope (RealtimeMonitor* monitor)
+    : previous (currentMonitor)
+{
+    currentMonitor = monitor;
+}
+
+RealtimeMonitor::WorkerScope::~WorkerScope()
+{
+    currentMonitor = previous;
+}
+
+#else
+
+void RealtimeMonitor::noteAllocation() noexcept {}
+void RealtimeMonitor::noteDeallocation() noexcept {}
+void RealtimeMonitor::noteLockAcquired() noexcept {}
+
+RealtimeMonitor* RealtimeMonitor::getCurrent() noexcept { return nullptr; }
+
+RealtimeMonitor::AudioScope::AudioScope (RealtimeMonitor&, int, double) {}
+RealtimeMonitor::AudioScope::~AudioScope() = default;
+
+RealtimeMonitor::WorkerScope::WorkerScope (RealtimeMonitor*) {}
+RealtimeMonitor::WorkerScope::~WorkerScope() = default;
+
+#endif
+
+//==============================================================================
+juce::uint64 RealtimeMonitor::getNumViolations() const noexcept
+{
+    return allocations.load (std::memory_order_relaxed)
+         + deallocations.load (std::memory_order_relaxed)
+         + lockAcquisitions.load (std::memory_order_relaxed);
+}
+
+RealtimeMonitor::Snapshot RealtimeMonitor::getSnapshot() const
+{
+    Snapshot s;
+    s.blocks = blocks.load (std::memory_order_acquire);
+    s.allocations = allocations.load (std::memory_order_relaxed);
+    s.deallocations = deallocations.load (std::memory_order_relaxed);
+    s.lockAcquisitions = lockAcquisitions.load (std::memory_order_relaxed);
+    s.blocksWithViolations = blocksWithViolations.load (std::memory_order_relaxed);
+    s.deadlineMisses = deadlineMisses.load (std::memory_order_relaxed);
+    s.worstLoad = worstLoad.load (std::memory_order_relaxed);
+    s.averageLoad = s.blocks > 0 ? totalLoad.load (std::memory_order_relaxed) / (double) s.blocks : 0.0;
+    return s;
+}
+
+juce::String RealtimeMonitor::Snapshot::toString() const
+{
+    if (! isEnabled())
+        return "Real-time checks are not compiled in (build with NEUTRON_REALTIME_CHECKS=ON)";
+
+    juce::String text;
+    text << "Blocks: " << juce::String (blocks)
+         << ", violating: " << juce::String (blocksWithViolations) << "\n"
+         << "Allocations: " << juce::String (allocations)
+         << ", frees: " << juce::String (deallocations)
+         << ", locks: " << juce::String (lockAcquisitions) << "\n"
+         << "Load: avg " << juce::String (averageLoad * 100.0, 1) << "%"
+         << ", worst " << juce::String (worstLoad * 100.0, 1) << "%"
+         << ", missed deadlines: " << juce::String (deadlineMisses);
+    return text;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#ifndef NEUTRON_REALTIME_CHECKS
+ #define NEUTRON_REALTIME_CHECKS 0
+#endif
+
+//==============================================================================
+/** Opt-in checks for things the audio thread must never do.
+
+    With NEUTRON_REALTIME_CHECKS enabled (the NEUTRON_REALTIME_CHECKS CMake
+    option), global operator new/delete and, on Linux, pthread_mutex_lock are
+    hooked, and every call made from inside an AudioScope is counted against
+    that scope's monitor. Each block's render time is also measured against
+    the time the block represents.
+
+    Without it, AudioScope is empty and all of this compiles away.
+
+    Mutex acquisition can only be seen where the hook takes precedence over
+    the C library's, i.e. in executables such as the Standalone app and the
+    command line tools, not in plugins loaded by a host.
+*/
+class RealtimeMonitor
+{
+public:
+    struct Snapshot
+    {
+        juce::uint64 blocks = 0;
+        juce::uint64 allocations = 0;
+        juce::uint64 deallocations = 0;
+        juce::uint64 lockAcquisitions = 0;
+        juce::uint64 blocksWithViolations = 0;
+        juce::uint64 deadlineMisses = 0;
+
+        double worstLoad = 0.0;     // render time / block duration
+        double averageLoad = 0.0;
+
+        juce::String toString() const;
+    };
+
+    static constexpr bool isEnabled()     { return NEUTRON_REALTIME_CHECKS != 0; }
+
+    /** Can be read from any thread while the audio thread is running. */
+    Snapshot getSnapshot() const;
+
+    /** The monitor of the scope the calling thread is in, or nullptr. */
+    static RealtimeMonitor* getCurrent() noexcept;
+
+    //==============================================================================
+    /** Marks the calling thread as rendering audio for the monitor, for the
+        lifetime of the scope, and times it against the block's deadline.
+    */
+    class AudioScope
+    {
+    public:
+        AudioScope (RealtimeMonitor& monitor, int numSamples, double sampleRate);
+        ~AudioScope();
+
+       #if NEUTRON_REALTIME_CHECKS
+    private:
+        RealtimeMonitor& monitor;
+        RealtimeMonitor* previous;
+        juce::uint64 violationsBefore;
+        double deadlineSeconds;
+        juce::int64 startTicks;
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (AudioScope)
+    };
+
+    /** Counts the calling thread against a monitor for the lifetime of the
+        scope, without timing it as a block. For threads doing part of the work
+        of an AudioScope on another thread, which pass in that thread's
+        getCurrent(). A nullptr monitor leaves the thread unmonitored.
+    */
+    class WorkerScope
+    {
+    public:
+        explicit WorkerScope (RealtimeMonitor* monitor);
+        ~WorkerScope();
+
+       #if NEUTRON_REALTIME_CHECKS
+    private:
+        RealtimeMonitor* previous;
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (WorkerScope)
+    };
+
+    //==============================================================================
+    /** Called by the hooks, on whichever thread allocated or locked. */
+    static void noteAllocation() noexcept;
+    static void noteDeallocation() noexcept;
+    static void noteLockAcquired() noexcept;
+
+private:
+    juce::uint64 getNumViolations() const noexcept;
+
+    std::atomic<juce::uint64> blocks { 0 }, allocations { 0 }, deallocations { 0 }, lockAcquisitions { 0 };
+    std::atomic<juce::uint64> blocksWithViolations { 0 }, deadlineMisses { 0 };
+    std::atomic<double> worstLoad { 0.0 }, totalLoad { 0.0 };
+};
@@ -0,0 +1,136 @@
+#include "OfflineRenderer.h"
+
+//==============================================================================
+/** Checks of the offline render path, run by ctest. */
+namespace
+{
+    class RenderIsolationTest final : public juce::UnitTest
+    {
+    public:
+        RenderIsolationTest() : juce::UnitTest ("Render isolation", "Render") {}
+
+        void runTest() override
+        {
+            beginTest ("A job renders bit-identically whichever job ran before it");
+
+            // The other job leaves a user waveform and both LFOs part way
+            // through their cycle behind, which the first job would hear
+            juce::TemporaryFile cycleFile (".wav"), stateFile (".state");
+            expect (writeSawCycle (cycleFile.getFile()), "couldn't write the test waveform");
+            expect (writeStateWithUserWaveform (cycleFile.getFile(), stateFile.getFile()), "couldn't write the test state");
+
+            RenderJob job;
+            job.parameters = { "OSC1_WAVE=User", "OSC2_WAVE=Saw", "LFO_RATE=3", "LFO_DEPTH=0.7",
+                               "LFO2_RATE=5", "MOD1_SOURCE=LFO 2", "MOD1_DESTINATION=Pitch", "MOD1_DEPTH=0.3" };
+            addNote (job.midiSequence, 0.0, 0.6, 57, 0.8f);
+            addNote (job.midiSequence, 0.3, 0.5, 64, 0.6f);
+            job.tailSeconds = 0.3;
+
+            RenderJob other;
+            other.stateFile = stateFile.getFile();
+            other.parameters = { "OSC1_WAVE=User", "LFO_RATE=1.3", "LFO2_RATE=0.7" };
+            addNote (other.midiSequence, 0.0, 0.77, 45, 0.9f);
+            other.tailSeconds = 0.11;
+
+            OfflineRenderer first, second;
+
+            expect (first.render (job).succeeded);
+            const juce::AudioBuffer<float> firstOutput (first.getOutput());
+            expect (first.render (other).succeeded);
+
+            expect (second.render (other).succeeded);
+            expect (second.render (job).succeeded);
+
+            // And once more on a renderer that has run both
+            const juce::AudioBuffer<float> secondOutput (second.getOutput());
+            expect (first.render (job).succeeded);
+
+            expectIdentical (firstOutput, secondOutput);
+            expectIdentical (firstOutput, first.getOutput());
+        }
+
+    private:
+        static void addNote (juce::MidiMessageSequence& sequence, double start, double length, int note, float velocity)
+        {
+            sequence.addEvent (juce::MidiMessage::noteOn (1, note, velocity), start);
+            sequence.addEvent (juce::MidiMessage::noteOff (1, note), start + length);
+        }
+
+        static bool writeSawCycle (const juce::File& file)
+        {
+            constexpr int length = 600;
+            juce::AudioBuffer<float> cycle (1, length);
+
+            for (int i = 0; i < length; ++i)
+                cycle.setSample (0, i, 2.0f * (float) i / length - 1.0f);
+
+            auto stream = std::make_unique<juce::FileOutputStream> (file);
+
+            if (! stream->openedOk())
+                return false;
+
+            juce::WavAudioFormat wav;
+            std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), 48000.0, 1, 24, {}, 0));
+
+            if (writer == nullptr)
+                return false;
+
+            stream.release();   // the writer owns it now
+            return writer->writeFromAudioSampleBuffer (cycle, 0, length);
+        }
+
+        static bool writeStateWithUserWaveform (const juce::File& cycleFile, const juce::File& stateFile)
+        {
+            AudioPluginAudioProcessor processor;
+
+            if (! processor.loadUserWaveform (cycleFile))
+                return false;
+
+            juce::MemoryBlock state;
+            processor.getStateInformation (state);
+            return stateFile.replaceWithData (state.getData(), state.getSize());
+        }
+
+        void expectIdentical (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+        {
+            expectEquals (b.getNumChannels(), a.getNumChannels());
+            expectEquals (b.getNumSamples(), a.getNumSamples());
+
+            if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+                return;
+
+            for (int channel = 0; channel < a.getNumChannels(); ++channel)
+            {
+                for (int i = 0; i < a.getNumSamples(); ++i)
+                {
+                    if (a.getSample (channel, i) != b.getSample (channel, i))
+                    {
+                        expect (false, "channel " + juce::String (channel) + " differs from sample " + juce::String (i));
+                        return;
+                    }
+                }
+            }
+        }
+    };
+
+    RenderIsolationTest renderIsolationTest;
+}
+
+//==============================================================================
+int main()
+{
+    // The processor's parameter tree needs a message manager, but nothing here
+    // opens a window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure (false);
+    runner.runAllTests();
+
+    int numFailures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult (i)->failures;
+
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#include "BatchRenderer.h"
+
+#include <iostream>
+
+//==============================================================================
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "Renders MIDI files through JuceNeutron into WAV files, as fast as possible.\n\n"
+                     "Usage: JuceNeutronRender --midi=<file.mid> --out=<file.wav> [options]\n"
+                     "       JuceNeutronRender --batch=<jobs.txt> [--threads=<n>] [options]\n\n"
+                     "  --state=<file>       state blob as written by getStateInformation()\n"
+                     "  --params=<file>      PARAMETER_ID=value lines, applied after --state\n"
+                     "  --rate=<hz>          sample rate (default 48000)\n"
+                     "  --block=<n>          block size passed to processBlock (default 512)\n"
+                     "  --tail=<seconds>     time rendered after the last MIDI event (default 2)\n"
+                     "  --double             render through the double precision processBlock\n"
+                     "  --voice-threads=<n>  worker threads helping each render's voices (default 0)\n"
+                     "  --trace=<file>       write the render's block timings as Chrome trace JSON\n\n"
+                     "Each line of a batch file holds the options of one job, e.g.\n"
+                     "  --midi=bass.mid --out=bass.wav --params=bass.txt\n"
+                     "Options given on the command line are the defaults for every job, and\n"
+                     "relative paths in the batch file are relative to the batch file.\n";
+    }
+
+    juce::File getFileOption (const juce::ArgumentList& args, juce::StringRef option, const juce::File& directory)
+    {
+        const auto value = args.getValueForOption (option);
+        return value.isEmpty() ? juce::File() : directory.getChildFile (value.unquoted());
+    }
+
+    void applyOptions (const juce::ArgumentList& args, const juce::File& directory, RenderJob& job)
+    {
+        for (auto [option, file] : { std::pair { "--midi",   &job.midiFile },
+                                     std::pair { "--state",  &job.stateFile },
+                                     std::pair { "--params", &job.parameterFile },
+                                     std::pair { "--out",    &job.outputFile },
+                                     std::pair { "--trace",  &job.traceFile } })
+            if (args.containsOption (option))
+                *file = getFileOption (args, option, directory);
+
+        if (args.containsOption ("--rate"))
+            job.sampleRate = args.getValueForOption ("--rate").getDoubleValue();
+
+        if (args.containsOption ("--block"))
+            job.blockSize = args.getValueForOption ("--block").getIntValue();
+
+        if (args.containsOption ("--tail"))
+            job.tailSeconds = args.getValueForOption ("--tail").getDoubleValue();
+
+        if (args.containsOption ("--double"))
+            job.doublePrecision = true;
+
+        if (args.containsOption ("--voice-threads"))
+            job.parameters.add (AudioPluginAudioProcessor::VOICE_THREADS + "=" + args.getValueForOption ("--voice-threads"));
+    }
+
+    juce::Result readBatchFile (const juce::File& file, const RenderJob& defaults, std::vector<RenderJob>& jobs)
+    {
+        if (! file.existsAsFile())
+            return juce::Result::fail ("Batch file not found: " + file.getFullPathName());
+
+        juce::StringArray lines;
+        file.readLines (lines);
+
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            const auto line = lines[i].trim();
+
+            if (line.isEmpty() || line.startsWith ("#"))
+                continue;
+
+            auto job = defaults;
+            applyOptions (juce::ArgumentList ({}, juce::StringArray::fromTokens (line, true)), file.getParentDirectory(), job);
+
+            if (job.outputFile == juce::File())
+                return juce::Result::fail (file.getFileName() + ":" + juce::String (i + 1) + ": no --out given");
+
+            jobs.push_back (job);
+        }
+
+        return juce::Result::ok();
+    }
+
+    juce::String describe (const RenderResult& result)
+    {
+        return juce::String (result.audioSeconds, 2) + " s audio in " + juce::String (result.renderSeconds, 3)
+                 + " s (" + juce::String (result.getRealtimeFactor(), 1) + "x realtime, "
+                 + juce::String (result.jobSeconds, 3) + " s including I/O)";
+    }
+
+    int renderBatch (const juce::ArgumentList& args, const RenderJob& defaults)
+    {
+        std::vector<RenderJob> jobs;
+
+        if (auto loaded = readBatchFile (getFileOption (args, "--batch", juce::File::getCurrentWorkingDirectory()), defaults, jobs);
+            loaded.failed())
+        {
+            std::cerr << "Error: " << loaded.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        const auto numThreads = args.containsOption ("--threads") ? args.getValueForOption ("--threads").getIntValue()
+                                                                  : juce::SystemStats::getNumCpus();
+
+        BatchRenderer renderer (juce::jmin (numThreads, juce::jmax (1, static_cast<int> (jobs.size()))));
+        const auto report = renderer.render (jobs);
+
+        int numFailed = 0;
+
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            const auto& job = report.jobs[i];
+            std::cout << "[" << job.worker << "] " << jobs[i].outputFile.getFileName() << ": ";
+
+            if (job.result.succeeded)
+            {
+                std::cout << describe (job.result) << "\n";
+            }
+            else
+            {
+                std::cout << "FAILED, " << job.result.error << "\n";
+                ++numFailed;
+            }
+        }
+
+        std::cout << "\n" << jobs.size() - (size_t) numFailed << " of " << jobs.size() << " jobs rendered on "
+                  << renderer.getNumWorkers() << " threads in " << juce::String (report.wallSeconds, 3) << " s\n"
+                  << "  throughput: " << juce::String (report.getThroughput(), 1) << " s of audio per second" << std::endl;
+
+        return numFailed == 0 ? 0 : 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h") || ! (args.containsOption ("--out") || args.containsOption ("--batch")))
+    {
+        printUsage();
+        return args.containsOption ("--help|-h") ? 0 : 1;
+    }
+
+    // The processor's parameter tree needs a message manager, but nothing here
+    // opens a window, so this runs fine without a display
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderJob job;
+    applyOptions (args, juce::File::getCurrentWorkingDirectory(), job);
+
+    if (args.containsOption ("--batch"))
+        return renderBatch (args, job);
+
+    OfflineRenderer renderer;
+    const auto result = renderer.render (job);
+
+    if (! result.succeeded)
+    {
+        std::cerr << "Error: " << result.error << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << job.outputFile.getFullPathName() << "\n";
+
+    if (job.traceFile != juce::File())
+        std::cout << "Wrote " << job.traceFile.getFullPathName() << "\n";
+
+    std::cout << "  " << describe (result) << std::endl;
+
+    return 0;
+}
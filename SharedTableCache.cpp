@@ -0,0 +1,47 @@
+#include "SharedTableCache.h"
+
+std::mutex SharedTableCache::lock;
+std::map<std::pair<juce::String, double>, std::shared_ptr<SharedTableCache::Entry>> SharedTableCache::entries;
+
+//==============================================================================
+bool SharedTableCache::isReleased (Entry& entry)
+{
+    const std::lock_guard<std::mutex> scopedLock (entry.buildLock);
+    return entry.table.expired();
+}
+
+std::shared_ptr<const void> SharedTableCache::getOrBuild (const juce::String& kind, double sampleRate,
+                                                          const std::function<std::shared_ptr<const void>()>& build)
+{
+    std::shared_ptr<Entry> entry;
+
+    {
+        const std::lock_guard<std::mutex> scopedLock (lock);
+
+        // Drop the entries of released tables that nobody is looking up
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (it->second.use_count() == 1 && isReleased (*it->second))
+                it = entries.erase (it);
+            else
+                ++it;
+        }
+
+        auto& slot = entries[{ kind, sampleRate }];
+
+        if (slot == nullptr)
+            slot = std::make_shared<Entry>();
+
+        entry = slot;
+    }
+
+    // Only this key is held up while its table is built
+    const std::lock_guard<std::mutex> scopedLock (entry->buildLock);
+
+    if (auto table = entry->table.lock())
+        return table;
+
+    auto table = build();
+    entry->table = table;
+    return table;
+}
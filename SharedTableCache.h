@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <map>
+#include <mutex>
+
+//==============================================================================
+/** Precomputed tables shared by every plugin instance in the process.
+
+    Tables are immutable once built and keyed by kind and sample rate. The
+    first instance to ask for a key builds the table, every later one gets the
+    same copy, so instances after the first prepare almost for free and the
+    tables are only in the caches once. The cache itself holds no reference:
+    a table goes away with the last instance using it.
+
+    get() may be called from any number of threads at once, e.g. hosts that
+    prepare several instances in parallel. Concurrent requests for one key wait
+    for a single build; different keys build in parallel.
+*/
+class SharedTableCache
+{
+public:
+    /** Returns the table for kind and sampleRate, calling build() to create it
+        if no instance holds one at the moment. build() returns a
+        std::unique_ptr<Table>, and must only depend on the key. A kind must
+        always be used with the same Table type.
+    */
+    template <typename Table, typename Builder>
+    static std::shared_ptr<const Table> get (const juce::String& kind, double sampleRate, Builder&& build)
+    {
+        return std::static_pointer_cast<const Table> (getOrBuild (kind, sampleRate, [&]() -> std::shared_ptr<const void>
+        {
+            return std::shared_ptr<const Table> (build());
+        }));
+    }
+
+private:
+    static std::shared_ptr<const void> getOrBuild (const juce::String& kind, double sampleRate,
+                                                   const std::function<std::shared_ptr<const void>()>& build);
+
+    struct Entry
+    {
+        std::mutex buildLock;
+        std::weak_ptr<const void> table;
+    };
+
+    static bool isReleased (Entry&);
+
+    static std::mutex lock;
+    static std::map<std::pair<juce::String, double>, std::shared_ptr<Entry>> entries;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+/** Splits a host block into sub-blocks at MIDI event positions and on a fixed
+    internal control grid.
+
+    The grid runs in absolute sample time across host blocks, so whatever is
+    updated on a tick (parameters, LFOs) advances at the same rate whether the
+    host calls us with 16 or 4096 samples. No sub-block is ever longer than the
+    tick interval, so render callbacks can work on small, cache-resident buffers.
+*/
+class SubBlockScheduler
+{
+public:
+    static constexpr int defaultTickInterval = 32;
+
+    void reset (int newTickInterval = defaultTickInterval)
+    {
+        tickInterval = juce::jmax (1, newTickInterval);
+        samplesUntilTick = 0;
+    }
+
+    int getTickInterval() const     { return tickInterval; }
+
+    /** Walks one host block.
+
+        onEvent (const juce::MidiMessage&) is called for every event right before
+        the sample it is timestamped at, onTick() at every grid point and
+        onRender (int startSample, int numSamples) for each span in between.
+    */
+    template <typename EventCallback, typename TickCallback, typename RenderCallback>
+    void process (int numSamples, const juce::MidiBuffer& midi,
+                  EventCallback&& onEvent, TickCallback&& onTick, RenderCallback&& onRender)
+    {
+        auto event = midi.begin();
+        const auto lastEvent = midi.end();
+
+        for (int position = 0; position < numSamples;)
+        {
+            for (; event != lastEvent && (*event).samplePosition <= position; ++event)
+                onEvent ((*event).getMessage());
+
+            if (samplesUntilTick == 0)
+            {
+                onTick();
+                samplesUntilTick = tickInterval;
+            }
+
+            auto length = juce::jmin (numSamples - position, samplesUntilTick);
+
+            if (event != lastEvent)
+                length = juce::jmin (length, (*event).samplePosition - position);
+
+            onRender (position, length);
+
+            position += length;
+            samplesUntilTick -= length;
+        }
+
+        // Events stamped past the end of the block still take effect
+        for (; event != lastEvent; ++event)
+            onEvent ((*event).getMessage());
+    }
+
+private:
+    int tickInterval = defaultTickInterval;
+    int samplesUntilTick = 0;
+};
@@ -0,0 +1,753 @@
+#include "SynthVoice.h"
+
+namespace
+{
+    using Source = ModulationMatrix::Source;
+    using Destination = ModulationMatrix::Destination;
+
+    FilterCoefficients advance (FilterCoefficients c, const FilterCoefficients& increment, int samples)
+    {
+        c.g += increment.g * (float) samples;
+        c.gR2 += increment.gR2 * (float) samples;
+        c.h += increment.h * (float) samples;
+        return c;
+    }
+}
+
+//==============================================================================
+void VoicePool::prepare (double newSampleRate, const WavetableBank& newWavetables)
+{
+    sampleRate = newSampleRate;
+    wavetables = &newWavetables;
+    filterControl.prepare (newSampleRate, filterControlInterval);
+    filterControlRight.prepare (newSampleRate, filterControlInterval);
+    noteOnCounter = 0;
+    current = {};
+    modulation.setRoutes (current.modulationRoutes);
+    updateUnison();
+    reset();
+}
+
+void VoicePool::reset()
+{
+    voices.fill ({});
+    lanes = {};
+    samplesUntilControlPoint = 0;
+    renderedSecondFilter = false;
+}
+
+void VoicePool::setAccuracy (FastMath::Accuracy newAccuracy)
+{
+    accuracy = newAccuracy;
+    filterControl.setAccuracy (newAccuracy);
+    filterControlRight.setAccuracy (newAccuracy);
+}
+
+void VoicePool::setFilterControlInterval (int numSamples)
+{
+    filterControlInterval = juce::jmax (1, numSamples);
+}
+
+void VoicePool::setThreadPool (VoiceThreadPool* pool, int minSamples)
+{
+    threadPool = pool;
+    minParallelSamples = juce::jmax (1, minSamples);
+}
+
+void VoicePool::noteOn (int midiNoteNumber, float velocity)
+{
+    int target = -1;
+
+    // Retrigger a voice that is already sounding this note
+    for (int i = 0; i < maxVoices && target < 0; ++i)
+        if (voices[(size_t) i].isActive() && voices[(size_t) i].getNoteNumber() == midiNoteNumber)
+            target = i;
+
+    for (int i = 0; i < maxVoices && target < 0; ++i)
+        if (! voices[(size_t) i].isActive())
+            target = i;
+
+    if (target < 0)
+        target = findVoiceToSteal();
+
+    startVoice (target, midiNoteNumber, velocity);
+}
+
+void VoicePool::noteOff (int midiNoteNumber)
+{
+    for (int i = 0; i < maxVoices; ++i)
+        if (voices[(size_t) i].isKeyDown() && voices[(size_t) i].getNoteNumber() == midiNoteNumber)
+            stopVoice (i);
+}
+
+void VoicePool::allNotesOff()
+{
+    for (int i = 0; i < maxVoices; ++i)
+        if (voices[(size_t) i].isKeyDown())
+            stopVoice (i);
+}
+
+int VoicePool::findVoiceToSteal() const
+{
+    // Prefer the quietest voice that is already releasing, otherwise take the
+    // oldest held note.
+    int quietestReleased = -1;
+    int oldest = 0;
+
+    for (int i = 0; i < maxVoices; ++i)
+    {
+        const auto& voice = voices[(size_t) i];
+
+        if (! voice.isKeyDown()
+             && (quietestReleased < 0 || lanes.envelopeLevel[i] < lanes.envelopeLevel[quietestReleased]))
+            quietestReleased = i;
+
+        if (voice.getNoteOnOrder() < voices[(size_t) oldest].getNoteOnOrder())
+            oldest = i;
+    }
+
+    return quietestReleased >= 0 ? quietestReleased : oldest;
+}
+
+void VoicePool::startVoice (int index, int midiNoteNumber, float velocity)
+{
+    auto& voice = voices[(size_t) index];
+
+    // A voice coming back from silence starts from a clean slate, a retriggered
+    // or stolen one keeps its phases and filter state so it doesn't click.
+    if (! voice.isActive())
+    {
+        // Unison copies start spread around the cycle, otherwise they would
+        // sound as one until they drift apart
+        for (int copy = 0; copy < VoiceLanes::maxUnison; ++copy)
+        {
+            const auto phase = std::fmod ((float) copy * 0.618034f, 1.0f);
+            lanes.osc1Phase[copy][index] = phase;
+            lanes.osc2Phase[copy][index] = phase;
+        }
+
+        lanes.envelopeLevel[index] = 0.0f;
+
+        for (int side = 0; side < 2; ++side)
+        {
+            lanes.ic1eq[side][index] = 0.0f;
+            lanes.ic2eq[side][index] = 0.0f;
+        }
+
+        // Successive notes take turns on either side, working inwards, so a
+        // chord spreads out whatever order its notes arrive in
+        static constexpr float panPattern[] = { -1.0f, 1.0f, -0.5f, 0.5f, -0.75f, 0.75f, -0.25f, 0.25f };
+        voice.panPosition = panPattern[noteOnCounter % std::size (panPattern)];
+    }
+
+    voice.noteNumber = midiNoteNumber;
+    voice.velocity = velocity;
+    voice.noteOnOrder = ++noteOnCounter;
+    voice.keyDown = true;
+    voice.pitchRatio = std::pow (2.0, (midiNoteNumber - SynthVoice::referenceNote) / 12.0);
+
+    // The voice's own sources have changed, so its modulation is brought up to
+    // date before the oscillators and mix jump to it
+    modulation.setSource (Source::velocity, index, velocity);
+
+    if (modulation.isActive())
+    {
+        modulation.setSource (Source::envelope, index, lanes.envelopeLevel[index]);
+        modulation.evaluate();
+    }
+
+    updateOscillators (index);
+    updateMix (index, true);
+    updatePan (index);
+    enterStage (index, SynthVoice::Stage::attack);
+}
+
+void VoicePool::stopVoice (int index)
+{
+    auto& voice = voices[(size_t) index];
+    voice.keyDown = false;
+
+    if (voice.isActive())
+        enterStage (index, SynthVoice::Stage::release);
+}
+
+void VoicePool::enterStage (int index, SynthVoice::Stage newStage)
+{
+    voices[(size_t) index].stage = newStage;
+
+    // The release slope is fixed when the note is released, like juce::ADSR
+    if (newStage == SynthVoice::Stage::release)
+        lanes.envelopeRate[index] = current.envelope.release > 0.0f
+                                      ? static_cast<float> (-lanes.envelopeLevel[index] / (current.envelope.release * sampleRate))
+                                      : 0.0f;
+
+    updateEnvelopeSegment (index);
+}
+
+void VoicePool::updateEnvelopeSegment (int index)
+{
+    auto& voice = voices[(size_t) index];
+    auto& level = lanes.envelopeLevel[index];
+    auto& rate = lanes.envelopeRate[index];
+    auto& target = lanes.envelopeTarget[index];
+
+    constexpr auto forever = std::numeric_limits<int>::max();
+
+    // Stages with zero length fall straight through to the next one
+    for (;;)
+    {
+        switch (voice.stage)
+        {
+            case SynthVoice::Stage::attack:
+                if (current.envelope.attack > 0.0f && level < 1.0f)
+                {
+                    rate = static_cast<float> (1.0 / (current.envelope.attack * sampleRate));
+                    target = 1.0f;
+                    voice.samplesToTarget = juce::jmax (1, static_cast<int> (std::ceil ((1.0f - level) / rate)));
+                    return;
+                }
+
+                level = 1.0f;
+                voice.stage = SynthVoice::Stage::decay;
+                break;
+
+            case SynthVoice::Stage::decay:
+                if (current.envelope.decay > 0.0f && level > current.envelope.sustain)
+                {
+                    rate = static_cast<float> (-(1.0 - current.envelope.sustain) / (current.envelope.decay * sampleRate));
+                    target = current.envelope.sustain;
+                    voice.samplesToTarget = juce::jmax (1, static_cast<int> (std::ceil ((level - current.envelope.sustain) / -rate)));
+                    return;
+                }
+
+                voice.stage = SynthVoice::Stage::sustain;
+                break;
+
+            case SynthVoice::Stage::sustain:
+                level = current.envelope.sustain;
+                rate = 0.0f;
+                target = current.envelope.sustain;
+                voice.samplesToTarget = forever;
+                return;
+
+            case SynthVoice::Stage::release:
+                if (rate < 0.0f && level > 0.0f)
+                {
+                    target = 0.0f;
+                    voice.samplesToTarget = juce::jmax (1, static_cast<int> (std::ceil (level / -rate)));
+                    return;
+                }
+
+                voice.stage = SynthVoice::Stage::idle;
+                break;
+
+            case SynthVoice::Stage::idle:
+            default:
+                voice.stage = SynthVoice::Stage::idle;
+                voice.noteNumber = -1;
+                voice.keyDown = false;
+                level = 0.0f;
+                rate = 0.0f;
+                target = 0.0f;
+                voice.samplesToTarget = forever;
+                return;
+        }
+    }
+}
+
+juce::uint32 VoicePool::getActiveGroups (juce::uint32 groups) const
+{
+    juce::uint32 active = 0;
+
+    for (int group = 0; group < numGroups; ++group)
+    {
+        if ((groups & (1u << group)) == 0)
+            continue;
+
+        // A voice held at a sustain level of zero stays active, but adds
+        // nothing until the envelope moves again
+        for (int i = group * lanesPerGroup; i < (group + 1) * lanesPerGroup; ++i)
+            if (voices[(size_t) i].isActive() && (lanes.envelopeLevel[i] != 0.0f || lanes.envelopeRate[i] != 0.0f))
+                active |= 1u << group;
+    }
+
+    return active;
+}
+
+double VoicePool::getPitchRatio (int index) const
+{
+    const auto ratio = voices[(size_t) index].pitchRatio;
+
+    if (! modulation.modulates (Destination::pitch))
+        return ratio;
+
+    return ratio * FastMath::exp2 (accuracy, modulation.getAmount (Destination::pitch, index) / 12.0f);
+}
+
+void VoicePool::updateOscillators (int index)
+{
+    const auto ratio = getPitchRatio (index) / sampleRate;
+
+    // Increments are capped at Nyquist so a single wrap per sample is enough
+    const auto increment1 = juce::jmin (0.5, current.osc1Frequency * ratio);
+    const auto increment2 = juce::jmin (0.5, current.osc2Frequency * ratio);
+    const auto ramp1 = current.osc1FrequencyStep * ratio;
+    const auto ramp2 = current.osc2FrequencyStep * ratio;
+
+    lanes.osc1Increment[index] = static_cast<float> (increment1);
+    lanes.osc2Increment[index] = static_cast<float> (increment2);
+    lanes.osc1IncrementRamp[index] = static_cast<float> (ramp1);
+    lanes.osc2IncrementRamp[index] = static_cast<float> (ramp2);
+
+    const auto span = (double) filterControlInterval;
+    updateTables (index, juce::jlimit (increment1, 0.5, increment1 + ramp1 * span),
+                         juce::jlimit (increment2, 0.5, increment2 + ramp2 * span));
+}
+
+void VoicePool::glideOscillators (int index)
+{
+    // Modulated pitch moves every tick. Rather than jumping there, which would
+    // step the pitch at control rate, the increments ramp from wherever they
+    // are to where the next tick expects them.
+    const auto ratio = getPitchRatio (index) / sampleRate;
+    const auto span = (double) filterControlInterval;
+    const auto increment1 = (double) lanes.osc1Increment[index];
+    const auto increment2 = (double) lanes.osc2Increment[index];
+    const auto target1 = juce::jmin (0.5, (current.osc1Frequency + current.osc1FrequencyStep * span) * ratio);
+    const auto target2 = juce::jmin (0.5, (current.osc2Frequency + current.osc2FrequencyStep * span) * ratio);
+
+    lanes.osc1IncrementRamp[index] = static_cast<float> ((target1 - increment1) / span);
+    lanes.osc2IncrementRamp[index] = static_cast<float> ((target2 - increment2) / span);
+
+    updateTables (index, juce::jmin (0.5, juce::jmax (increment1, target1)),
+                         juce::jmin (0.5, juce::jmax (increment2, target2)));
+}
+
+void VoicePool::updateTables (int index, double peak1, double peak2)
+{
+    // Pick the table for the highest pitch the ramp reaches before the next
+    // update, and the sharpest unison copy, so neither can alias
+    lanes.osc1Table[index] = wavetables->getTable (current.osc1WaveType, (float) (peak1 * unisonMaxRatio));
+    lanes.osc2Table[index] = wavetables->getTable (current.osc2WaveType, (float) (peak2 * unisonMaxRatio));
+}
+
+void VoicePool::updateMix (int index, bool jump)
+{
+    if (! modulation.modulates (Destination::mix))
+    {
+        lanes.osc1Gain[index] = current.mixLevel1 * outputGain;
+        lanes.osc2Gain[index] = current.mixLevel2 * outputGain;
+        lanes.osc1GainRamp[index] = current.mixLevel1Step * outputGain;
+        lanes.osc2GainRamp[index] = current.mixLevel2Step * outputGain;
+        return;
+    }
+
+    // Modulation shifts the balance towards oscillator 2, or away from it for
+    // negative amounts. The gains head for the next tick's levels like the
+    // modulated pitch does, or jump straight to this tick's for a new note.
+    const auto amount = modulation.getAmount (Destination::mix, index);
+    const auto span = jump ? 0.0f : (float) filterControlInterval;
+    const auto level1 = juce::jlimit (0.0f, 1.0f, current.mixLevel1 + current.mixLevel1Step * span - amount);
+    const auto level2 = juce::jlimit (0.0f, 1.0f, current.mixLevel2 + current.mixLevel2Step * span + amount);
+
+    if (jump)
+    {
+        lanes.osc1Gain[index] = level1 * outputGain;
+        lanes.osc2Gain[index] = level2 * outputGain;
+        lanes.osc1GainRamp[index] = 0.0f;
+        lanes.osc2GainRamp[index] = 0.0f;
+        return;
+    }
+
+    lanes.osc1GainRamp[index] = (level1 * outputGain - lanes.osc1Gain[index]) / span;
+    lanes.osc2GainRamp[index] = (level2 * outputGain - lanes.osc2Gain[index]) / span;
+}
+
+void VoicePool::updateModulation()
+{
+    if (! modulation.isActive())
+        return;
+
+    // All sources in one go, per tick. The LFOs read the same in every lane,
+    // the envelopes as they stand at the start of the tick.
+    modulation.setSource (Source::lfo1, current.lfo1);
+    modulation.setSource (Source::lfo2, current.lfo2);
+
+    if (modulation.uses (Source::envelope))
+        modulation.setSource (Source::envelope, lanes.envelopeLevel);
+
+    modulation.evaluate();
+}
+
+void VoicePool::setParameters (const VoiceRenderParameters& params)
+{
+    const auto pitchWasModulated = modulation.modulates (Destination::pitch);
+    current = params;
+
+    if ((params.changes & VoiceRenderParameters::modulationChanged) != 0)
+        modulation.setRoutes (params.modulationRoutes);
+
+    if ((params.changes & VoiceRenderParameters::envelopeChanged) != 0)
+        for (int i = 0; i < maxVoices; ++i)
+            if (voices[(size_t) i].isActive())
+                updateEnvelopeSegment (i);
+
+    if ((params.changes & VoiceRenderParameters::filterChanged) != 0)
+    {
+        filterControl.setTargets (params.filterCutoff, params.filterResonance);
+        filterControlRight.setTargets (params.filterCutoffRight, params.filterResonance);
+    }
+
+    if ((params.changes & VoiceRenderParameters::panChanged) != 0)
+        for (int i = 0; i < maxVoices; ++i)
+            updatePan (i);
+
+    if ((params.changes & VoiceRenderParameters::unisonChanged) != 0)
+        updateUnison();
+
+    updateModulation();
+
+    // Idle lanes still run alongside active ones in their register, so they
+    // need a valid table too
+    constexpr auto oscillatorChanges = VoiceRenderParameters::waveTypesChanged
+                                     | VoiceRenderParameters::tuningChanged
+                                     | VoiceRenderParameters::unisonChanged;
+
+    if (modulation.modulates (Destination::pitch))
+    {
+        for (int i = 0; i < maxVoices; ++i)
+            glideOscillators (i);
+    }
+    else if ((params.changes & oscillatorChanges) != 0 || pitchWasModulated)
+    {
+        for (int i = 0; i < maxVoices; ++i)
+            updateOscillators (i);
+    }
+
+    for (int i = 0; i < maxVoices; ++i)
+        updateMix (i, false);
+}
+
+void VoicePool::updateUnison()
+{
+    const auto numCopies = juce::jlimit (1, VoiceLanes::maxUnison, current.unisonVoices);
+    current.unisonVoices = numCopies;
+
+    // Copies are spread evenly over the detune range and kept at roughly the
+    // loudness of a single one. Neighbouring copies go to opposite sides, so
+    // the pitch doesn't sweep across the stereo field.
+    const auto normalisation = 1.0f / std::sqrt ((float) numCopies);
+    unisonMaxRatio = 1.0;
+
+    for (auto* params : { &stereoUnison, &monoUnison })
+        params->unisonVoices = numCopies;
+
+    for (int copy = 0; copy < numCopies; ++copy)
+    {
+        const auto position = numCopies > 1 ? -1.0f + 2.0f * (float) copy / (float) (numCopies - 1) : 0.0f;
+        const auto ratio = std::pow (2.0, current.unisonDetune * position / 1200.0);
+        const auto pan = current.unisonWidth * position * ((copy & 1) != 0 ? -1.0f : 1.0f);
+
+        for (auto* params : { &stereoUnison, &monoUnison })
+            params->unisonRatio[copy] = (float) ratio;
+
+        stereoUnison.unisonLeft[copy] = normalisation * juce::jmin (1.0f, 1.0f - pan);
+        stereoUnison.unisonRight[copy] = normalisation * juce::jmin (1.0f, 1.0f + pan);
+        monoUnison.unisonLeft[copy] = normalisation;
+        monoUnison.unisonRight[copy] = normalisation;
+
+        unisonMaxRatio = juce::jmax (unisonMaxRatio, ratio);
+    }
+}
+
+void VoicePool::updatePan (int index)
+{
+    const auto pan = current.panSpread * voices[(size_t) index].panPosition;
+    lanes.panLeft[index] = juce::jmin (1.0f, 1.0f - pan);
+    lanes.panRight[index] = juce::jmin (1.0f, 1.0f + pan);
+}
+
+bool VoicePool::isStereo() const
+{
+    return hasUnisonSpread()
+        || current.panSpread > 0.0f
+        || current.filterCutoffRight != current.filterCutoff
+        || filterCoefficientsRight != filterCoefficients
+        || filterIncrementRight != filterIncrement;
+}
+
+void VoicePool::renderNextBlock (float* outputLeft, float* outputRight, int numSamples)
+{
+    const auto stereo = outputRight != nullptr && isStereo();
+
+    for (int position = 0; position < numSamples;)
+    {
+        const auto span = juce::jmin (maxSpan, numSamples - position);
+        const auto activeGroups = getActiveGroups();
+        auto* left = outputLeft + position;
+        auto* right = stereo ? outputRight + position : nullptr;
+
+        {
+            const BlockTrace::SpanScope filterSpan (trace, BlockTrace::Stage::filter);
+            planControlPoints (span);
+        }
+
+        // Panning alone shares the left filter. The right one only runs when
+        // the sides differ going into it or in its coefficients, and picks up
+        // from the left one instead of from stale state when it starts.
+        spanHasSecondFilter = stereo && (hasUnisonSpread() || spanFiltersDiffer);
+
+        if (spanHasSecondFilter && ! renderedSecondFilter)
+        {
+            std::copy (std::begin (lanes.ic1eq[0]), std::end (lanes.ic1eq[0]), lanes.ic1eq[1]);
+            std::copy (std::begin (lanes.ic2eq[0]), std::end (lanes.ic2eq[0]), lanes.ic2eq[1]);
+        }
+
+        renderedSecondFilter = spanHasSecondFilter;
+
+        const BlockTrace::SpanScope voicesSpan (trace, BlockTrace::Stage::voices);
+        int numTasks = 0;
+
+        if (threadPool != nullptr && threadPool->getNumWorkers() > 0 && span * current.unisonVoices >= minParallelSamples)
+            for (int group = 0; group < numGroups; ++group)
+                if ((activeGroups & (1u << group)) != 0)
+                    taskGroups[(size_t) numTasks++] = group;
+
+        if (numTasks > 1)
+        {
+            spanSamples = span;
+            spanIsStereo = stereo;
+            threadPool->run (renderGroupTask, this, numTasks);
+
+            // Summed in group order, so the result doesn't depend on which
+            // thread rendered what
+            for (int task = 0; task < numTasks; ++task)
+            {
+                const auto group = taskGroups[(size_t) task];
+                juce::FloatVectorOperations::add (left, groupOutput[0][group], span);
+
+                if (stereo)
+                    juce::FloatVectorOperations::add (right, groupOutput[1][group], span);
+            }
+        }
+        else
+        {
+            renderGroups (activeGroups, left, right, span);
+        }
+
+        current.osc1Frequency += current.osc1FrequencyStep * span;
+        current.osc2Frequency += current.osc2FrequencyStep * span;
+        current.mixLevel1 += current.mixLevel1Step * (float) span;
+        current.mixLevel2 += current.mixLevel2Step * (float) span;
+        position += span;
+    }
+}
+
+void VoicePool::renderGroupTask (void* context, int taskIndex)
+{
+    auto& pool = *static_cast<VoicePool*> (context);
+    const auto group = pool.taskGroups[(size_t) taskIndex];
+    auto* left = pool.groupOutput[0][group];
+    auto* right = pool.spanIsStereo ? pool.groupOutput[1][group] : nullptr;
+
+    juce::FloatVectorOperations::clear (left, pool.spanSamples);
+
+    if (right != nullptr)
+        juce::FloatVectorOperations::clear (right, pool.spanSamples);
+
+    pool.renderGroups (1u << group, left, right, pool.spanSamples);
+}
+
+void VoicePool::planControlPoints (int numSamples)
+{
+    numControlPoints = 0;
+
+    if (samplesUntilControlPoint > 0)
+        controlPoints[(size_t) numControlPoints++] = { 0, false, filterCoefficients, filterIncrement,
+                                                       filterCoefficientsRight, filterIncrementRight,
+                                                       filterControl.getCutoff(), filterControlRight.getCutoff(),
+                                                       filterControl.getResonance() };
+
+    auto position = samplesUntilControlPoint;
+
+    for (; position < numSamples; position += filterControl.getControlInterval())
+    {
+        const auto coefficients = filterControl.getNextControlStep (filterIncrement);
+        const auto coefficientsRight = filterControlRight.getNextControlStep (filterIncrementRight);
+        controlPoints[(size_t) numControlPoints++] = { position, true, coefficients, filterIncrement,
+                                                       coefficientsRight, filterIncrementRight,
+                                                       filterControl.getCutoff(), filterControlRight.getCutoff(),
+                                                       filterControl.getResonance() };
+    }
+
+    samplesUntilControlPoint = position - numSamples;
+
+    spanFiltersDiffer = false;
+
+    for (int i = 0; i < numControlPoints; ++i)
+    {
+        const auto& point = controlPoints[(size_t) i];
+        spanFiltersDiffer = spanFiltersDiffer || point.coefficientsRight != point.coefficients
+                                              || point.incrementRight != point.increment;
+    }
+
+    const auto& last = controlPoints[(size_t) numControlPoints - 1];
+    filterCoefficients = advance (last.coefficients, last.increment, numSamples - last.start);
+    filterCoefficientsRight = advance (last.coefficientsRight, last.incrementRight, numSamples - last.start);
+}
+
+void VoicePool::renderGroups (juce::uint32 groups, float* outputLeft, float* outputRight, int numSamples)
+{
+    auto kernelParams = outputRight != nullptr ? stereoUnison : monoUnison;
+    kernelParams.osc1WaveType = current.osc1WaveType;
+    kernelParams.osc2WaveType = current.osc2WaveType;
+    kernelParams.filterType = current.filterType;
+    kernelParams.accuracy = accuracy;
+    kernelParams.secondFilter = outputRight != nullptr && spanHasSecondFilter;
+
+    auto isInGroups = [groups] (int lane)       { return (groups & (1u << (lane / lanesPerGroup))) != 0; };
+
+    // Render up to the next filter control point or envelope stage boundary of
+    // any of these voices, whichever comes first, then advance whatever
+    // reached its end
+    int controlIndex = 0;
+
+    for (int position = 0; position < numSamples;)
+    {
+        while (controlIndex + 1 < numControlPoints && controlPoints[(size_t) controlIndex + 1].start <= position)
+            ++controlIndex;
+
+        const auto& point = controlPoints[(size_t) controlIndex];
+        const auto pointEnd = controlIndex + 1 < numControlPoints ? controlPoints[(size_t) controlIndex + 1].start
+                                                                  : numSamples;
+        auto segment = pointEnd - position;
+
+        for (int i = 0; i < maxVoices; ++i)
+            if (isInGroups (i) && voices[(size_t) i].isActive())
+                segment = juce::jmin (segment, voices[(size_t) i].samplesToTarget);
+
+        updateFilters (groups, point, position - point.start, kernelParams.secondFilter);
+
+        VoiceKernel::render (implementation, lanes, kernelParams, getActiveGroups (groups),
+                             outputLeft + position, outputRight != nullptr ? outputRight + position : nullptr, segment);
+        position += segment;
+
+        for (int i = 0; i < maxVoices; ++i)
+        {
+            auto& voice = voices[(size_t) i];
+
+            if (! isInGroups (i) || ! voice.isActive() || voice.samplesToTarget == std::numeric_limits<int>::max())
+                continue;
+
+            voice.samplesToTarget -= segment;
+
+            if (voice.samplesToTarget > 0)
+                continue;
+
+            lanes.envelopeLevel[i] = lanes.envelopeTarget[i];
+
+            switch (voice.stage)
+            {
+                case SynthVoice::Stage::attack:     enterStage (i, SynthVoice::Stage::decay); break;
+                case SynthVoice::Stage::decay:      enterStage (i, SynthVoice::Stage::sustain); break;
+                case SynthVoice::Stage::release:    enterStage (i, SynthVoice::Stage::idle); break;
+                case SynthVoice::Stage::sustain:
+                case SynthVoice::Stage::idle:
+                default:                            break;
+            }
+        }
+    }
+}
+
+void VoicePool::updateFilters (juce::uint32 groups, const ControlPoint& point, int offset, bool dual)
+{
+    const auto filterModulated = modulation.modulates (Destination::cutoff) || modulation.modulates (Destination::resonance);
+
+    for (int i = 0; i < maxVoices; ++i)
+    {
+        if ((groups & (1u << (i / lanesPerGroup))) == 0)
+            continue;
+
+        // Without modulation every lane follows the shared ramps, picked up at
+        // whatever point of them the segment starts
+        if (! filterModulated || ! voices[(size_t) i].isActive())
+        {
+            lanes.setFilter (0, i, advance (point.coefficients, point.increment, offset), point.increment);
+            lanes.setFilter (1, i, advance (point.coefficientsRight, point.incrementRight, offset), point.incrementRight);
+            continue;
+        }
+
+        // Modulated lanes carry their own coefficients from one control point
+        // to the next, and only change course at the points
+        if (offset != 0 || ! point.isNew)
+            continue;
+
+        const auto scale = 1.0f / (float) filterControlInterval;
+
+        auto glide = [this, i, scale] (int side, const FilterCoefficients& target)
+        {
+            const auto from = lanes.getFilter (side, i);
+            lanes.setFilter (side, i, from, { (target.g - from.g) * scale, (target.gR2 - from.gR2) * scale, (target.h - from.h) * scale });
+        };
+
+        glide (0, getModulatedFilter (i, point.cutoff, point.resonance));
+
+        // A right filter that isn't running can't follow a ramp, so it waits
+        // where it would have got to
+        if (point.cutoffRight == point.cutoff)
+            lanes.setFilter (1, i, lanes.getFilter (0, i), lanes.getFilterRamp (0, i));
+        else if (dual)
+            glide (1, getModulatedFilter (i, point.cutoffRight, point.resonance));
+        else
+            lanes.setFilter (1, i, getModulatedFilter (i, point.cutoffRight, point.resonance), {});
+    }
+}
+
+FilterCoefficients VoicePool::getModulatedFilter (int index, float cutoff, float resonance) const
+{
+    const auto octaves = modulation.getAmount (Destination::cutoff, index);
+    const auto offset = modulation.getAmount (Destination::resonance, index);
+
+    return filterControl.calculate (cutoff * FastMath::exp2 (accuracy, octaves),
+                                    juce::jlimit (FilterControl::minResonance, FilterControl::maxResonance, resonance + offset));
+}
+
+void VoicePool::jumpToNextTargets() noexcept
+{
+    filterControl.jumpToNextTargets();
+    filterControlRight.jumpToNextTargets();
+}
+
+int VoicePool::getNumActiveVoices() const
+{
+    int numActive = 0;
+
+    for (auto& voice : voices)
+        if (voice.isActive())
+            ++numActive;
+
+    return numActive;
+}
+
+VoicePool::Status VoicePool::getStatus() const
+{
+    Status status;
+    const SynthVoice* newest = nullptr;
+
+    for (size_t i = 0; i < voices.size(); ++i)
+    {
+        if (! voices[i].isActive())
+            continue;
+
+        ++status.activeVoices;
+
+        if (newest == nullptr || voices[i].getNoteOnOrder() > newest->getNoteOnOrder())
+        {
+            newest = &voices[i];
+            status.stage = newest->getStage();
+            status.envelopeLevel = lanes.envelopeLevel[i];
+        }
+    }
+
+    return status;
+}
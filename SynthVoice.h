@@ -0,0 +1,278 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "BlockTrace.h"
+#include "ModulationMatrix.h"
+#include "VoiceKernel.h"
+#include "VoiceThreadPool.h"
+
+//==============================================================================
+/** Everything the voices need until the next control tick. Filled by the
+    processor from its parameter snapshot so voices never touch the parameter
+    tree themselves.
+
+    Oscillator frequencies and mix levels are given at the start of the tick
+    together with their per-sample change, so automation is ramped rather than
+    stepped. The changes flags tell the pool what it needs to recompute.
+
+    The LFOs are ticked by the processor, which owns their phases, and only
+    their output for this tick is handed over; the routes say where it, and
+    the voices' own sources, go.
+*/
+struct VoiceRenderParameters
+{
+    enum Changes : juce::uint32
+    {
+        waveTypesChanged    = 1 << 0,
+        tuningChanged       = 1 << 1,
+        filterChanged       = 1 << 2,
+        envelopeChanged     = 1 << 3,
+        unisonChanged       = 1 << 4,
+        panChanged          = 1 << 5,
+        modulationChanged   = 1 << 6,
+        allChanged          = 0xffffffff
+    };
+
+    double osc1Frequency = 440.0;
+    double osc2Frequency = 440.0;
+    double osc1FrequencyStep = 0.0;     // per sample
+    double osc2FrequencyStep = 0.0;
+    int osc1WaveType = 0;
+    int osc2WaveType = 0;
+    float mixLevel1 = 0.5f;
+    float mixLevel2 = 0.5f;
+    float mixLevel1Step = 0.0f;
+    float mixLevel2Step = 0.0f;
+
+    float filterCutoff = 500.0f;
+    float filterCutoffRight = 500.0f;   // differs from filterCutoff when the LFO is out of phase between the sides
+    float filterResonance = 0.01f;
+    int filterType = 0;
+
+    juce::ADSR::Parameters envelope;
+
+    int unisonVoices = 1;               // copies of each oscillator
+    float unisonDetune = 0.0f;          // cents, of the outermost copies either side
+    float unisonWidth = 0.0f;           // 0 = all centred, 1 = outermost copies hard left and right
+
+    float panSpread = 0.0f;             // how far voices are spread across the stereo field, 0 to 1
+
+    ModulationMatrix::Routes modulationRoutes {};
+    float lfo1 = 0.0f;                  // this tick's LFO outputs, -1 to 1
+    float lfo2 = 0.0f;
+
+    juce::uint32 changes = allChanged;
+};
+
+//==============================================================================
+/** Note bookkeeping and envelope stage for one voice. The voice's DSP state
+    lives in its lane of the pool's VoiceLanes so it can be rendered with SIMD.
+
+    The oscillator frequency parameters are treated as the tuning of A4 (MIDI
+    note 69), so a voice playing note 69 sounds exactly at OSC1_FREQ/OSC2_FREQ.
+*/
+class SynthVoice
+{
+public:
+    enum class Stage
+    {
+        idle,
+        attack,
+        decay,
+        sustain,
+        release
+    };
+
+    bool isActive() const           { return stage != Stage::idle; }
+    bool isKeyDown() const          { return keyDown; }
+    int getNoteNumber() const       { return noteNumber; }
+    float getVelocity() const       { return velocity; }
+    juce::uint64 getNoteOnOrder() const { return noteOnOrder; }
+    Stage getStage() const          { return stage; }
+
+    static constexpr int referenceNote = 69;
+
+private:
+    friend class VoicePool;
+
+    Stage stage = Stage::idle;
+    int noteNumber = -1;
+    float velocity = 0.0f;
+    bool keyDown = false;
+    juce::uint64 noteOnOrder = 0;
+    double pitchRatio = 1.0;
+    float panPosition = 0.0f;           // -1 to 1, scaled by the pan spread
+    int samplesToTarget = 0;
+};
+
+//==============================================================================
+/** A fixed-size pool of voices with note-to-voice mapping and voice stealing.
+
+    Voice i renders in lane i of a structure-of-arrays VoiceLanes block. The
+    envelope stages are advanced here, splitting the block wherever a voice
+    reaches a stage boundary or the filter reaches a control point, while the
+    VoiceKernel renders the samples in between. All storage is fixed size, so
+    the audio thread never allocates.
+
+    The modulation matrix is evaluated for every lane once per control tick.
+    Modulated pitch, mix and filter settings then ramp per lane from where they
+    are to where the next tick wants them; destinations nothing modulates stay
+    on the shared values and ramps.
+
+    Lane groups only share read-only state while rendering, so with a thread
+    pool set they are rendered side by side and summed afterwards.
+*/
+class VoicePool
+{
+public:
+    static constexpr int maxVoices = VoiceLanes::numLanes;
+
+    void prepare (double sampleRate, const WavetableBank& wavetables);
+    void reset();
+
+    void noteOn (int midiNoteNumber, float velocity);
+    void noteOff (int midiNoteNumber);
+    void allNotesOff();
+
+    /** Takes the settings for the next control tick, which lasts the control
+        interval. Derived values are only recomputed for what the changes flags
+        mark, apart from the modulation, which moves every tick.
+    */
+    void setParameters (const VoiceRenderParameters& params);
+
+    /** Adds all active voices into the first numSamples of the outputs. With
+        outputRight set to nullptr the voices are mixed to mono into outputLeft.
+    */
+    void renderNextBlock (float* outputLeft, float* outputRight, int numSamples);
+
+    /** True when the output differs between left and right: the unison copies
+        or the voices are spread across the stereo field, or the two sides are
+        filtered differently.
+    */
+    bool isStereo() const;
+
+    int getNumActiveVoices() const;
+
+    /** Makes the filter jump to the settings of the next setParameters() rather
+        than glide there, e.g. after the pool sat silent without being rendered.
+    */
+    void jumpToNextTargets() noexcept;
+
+    struct Status
+    {
+        int activeVoices = 0;
+        SynthVoice::Stage stage = SynthVoice::Stage::idle;     // of the newest voice still sounding
+        float envelopeLevel = 0.0f;
+    };
+
+    /** A summary for display. */
+    Status getStatus() const;
+
+    /** Sets how many samples pass between control ticks, and so between
+        filter coefficient updates. Takes effect on the next prepare().
+    */
+    void setFilterControlInterval (int numSamples);
+
+    /** Lets renderNextBlock spread lane groups over the pool's workers, when at
+        least two groups are busy and a call covers at least minSamples, each
+        unison copy counted separately as that's what a group's cost scales
+        with. With nullptr everything renders on the calling thread.
+    */
+    void setThreadPool (VoiceThreadPool* pool, int minSamples = defaultMinParallelSamples);
+
+    // A group of four lanes takes about 55 ns per sample and unison copy with
+    // SSE, so this hands a worker at least 5 us of work, several times what
+    // passing it over costs. Realtime ticks of 32 samples go parallel from 3
+    // unison copies up; single copies and offline ticks stay on one thread.
+    static constexpr int defaultMinParallelSamples = 96;
+
+    /** Picks the sine and tan() approximations used by the voices. */
+    void setAccuracy (FastMath::Accuracy newAccuracy);
+
+    /** Where renderNextBlock records its stages, in builds with
+        NEUTRON_TRACE_STAGES. May be nullptr.
+    */
+    void setTrace (BlockTrace* newTrace) noexcept   { trace = newTrace; }
+
+private:
+    int findVoiceToSteal() const;
+    void startVoice (int index, int midiNoteNumber, float velocity);
+    void stopVoice (int index);
+    void enterStage (int index, SynthVoice::Stage newStage);
+    void updateEnvelopeSegment (int index);
+    void updateOscillators (int index);
+    void glideOscillators (int index);
+    void updateTables (int index, double peak1, double peak2);
+    double getPitchRatio (int index) const;
+    void updateMix (int index, bool jump);
+    void updateModulation();
+    void updateUnison();
+    void updatePan (int index);
+    bool hasUnisonSpread() const    { return current.unisonVoices > 1 && current.unisonWidth > 0.0f; }
+    juce::uint32 getActiveGroups (juce::uint32 groups = allGroups) const;
+
+    void planControlPoints (int numSamples);
+    void renderGroups (juce::uint32 groups, float* outputLeft, float* outputRight, int numSamples);
+    static void renderGroupTask (void* pool, int taskIndex);
+
+    static constexpr int lanesPerGroup = VoiceKernel::getLanesPerGroup();
+    static constexpr int numGroups = maxVoices / lanesPerGroup;
+    static constexpr juce::uint32 allGroups = (1u << numGroups) - 1;
+    static constexpr int maxSpan = 256;     // longest stretch planned and rendered in one go
+
+    std::array<SynthVoice, maxVoices> voices;
+    VoiceLanes lanes;
+    VoiceKernel::Implementation implementation = VoiceKernel::getBestImplementation();
+    FastMath::Accuracy accuracy = FastMath::Accuracy::exact;
+
+    const WavetableBank* wavetables = nullptr;
+
+    // The right side has its own filter control, which only differs from the
+    // left one while the LFO runs out of phase between them
+    FilterControl filterControl, filterControlRight;
+    FilterCoefficients filterCoefficients, filterIncrement;
+    FilterCoefficients filterCoefficientsRight, filterIncrementRight;
+    int filterControlInterval = FilterControl::defaultControlInterval;
+    int samplesUntilControlPoint = 0;
+
+    // Filter control points within the current span. Every group walks the
+    // same list, so they can be rendered independently of each other.
+    struct ControlPoint
+    {
+        int start = 0;
+        bool isNew = false;     // false for the one carried over from the previous span
+        FilterCoefficients coefficients, increment;
+        FilterCoefficients coefficientsRight, incrementRight;
+        float cutoff = 0.0f, cutoffRight = 0.0f, resonance = 0.0f;     // smoothed, where the step heads to
+    };
+
+    void updateFilters (juce::uint32 groups, const ControlPoint& point, int offset, bool dual);
+    FilterCoefficients getModulatedFilter (int index, float cutoff, float resonance) const;
+
+    std::array<ControlPoint, maxSpan + 2> controlPoints;
+    int numControlPoints = 0;
+    bool spanFiltersDiffer = false;
+
+    ModulationMatrix modulation;
+
+    VoiceThreadPool* threadPool = nullptr;
+    BlockTrace* trace = nullptr;
+    int minParallelSamples = defaultMinParallelSamples;
+    std::array<int, numGroups> taskGroups {};
+    int spanSamples = 0;
+    bool spanIsStereo = false, spanHasSecondFilter = false;
+    alignas (32) float groupOutput[2][numGroups][maxSpan] {};
+
+    // Per-copy settings handed to the kernel, for stereo and mono rendering
+    VoiceKernelParameters stereoUnison, monoUnison;
+    double unisonMaxRatio = 1.0;
+    bool renderedSecondFilter = false;
+
+    double sampleRate = 44100.0;
+    VoiceRenderParameters current;      // ramped values are kept up to date as samples are rendered
+    juce::uint64 noteOnCounter = 0;
+
+    static constexpr float outputGain = 0.15f;
+};
@@ -0,0 +1,164 @@
+#include "TelemetryView.h"
+
+namespace
+{
+    constexpr float minDecibels = -100.0f;
+    constexpr float peakFallPerFrame = 1.5f;    // dB
+    constexpr float spectrumLowestFrequency = 20.0f;
+
+    const char* getStageName (SynthVoice::Stage stage)
+    {
+        switch (stage)
+        {
+            case SynthVoice::Stage::attack:     return "Attack";
+            case SynthVoice::Stage::decay:      return "Decay";
+            case SynthVoice::Stage::sustain:    return "Sustain";
+            case SynthVoice::Stage::release:    return "Release";
+            case SynthVoice::Stage::idle:       break;
+        }
+
+        return "Idle";
+    }
+}
+
+//==============================================================================
+TelemetryView::TelemetryView (TelemetryChannel& channel)
+    : analyser (channel, framesPerSecond)
+{
+    setOpaque (true);
+    startTimerHz (framesPerSecond);
+}
+
+void TelemetryView::timerCallback()
+{
+    if (! analyser.getLatestFrame (frame))
+        return;
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        const auto peak = juce::Decibels::gainToDecibels (frame.peak[channel], minDecibels);
+        displayedPeak[channel] = juce::jmax (peak, displayedPeak[channel] - peakFallPerFrame);
+        displayedRms[channel] = juce::Decibels::gainToDecibels (frame.rms[channel], minDecibels);
+    }
+
+    repaint();
+}
+
+//==============================================================================
+void TelemetryView::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);
+
+    auto area = getLocalBounds().toFloat().reduced (4.0f);
+    auto meters = area.removeFromRight (30.0f);
+    area.removeFromRight (6.0f);
+
+    paintVoiceStatus (g, area.removeFromBottom (20.0f));
+    paintScope (g, area.removeFromTop (area.getHeight() * 0.4f).reduced (0.0f, 2.0f));
+    paintSpectrum (g, area.reduced (0.0f, 2.0f));
+
+    paintMeter (g, meters.removeFromLeft (14.0f), 0);
+    meters.removeFromLeft (2.0f);
+    paintMeter (g, meters, 1);
+}
+
+void TelemetryView::paintScope (juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    g.setColour (juce::Colours::darkgrey);
+    g.drawRect (area);
+    g.drawHorizontalLine (juce::roundToInt (area.getCentreY()), area.getX(), area.getRight());
+
+    juce::Path trace;
+    const auto xScale = area.getWidth() / (float) (TelemetryAnalyser::scopeSize - 1);
+
+    for (int i = 0; i < TelemetryAnalyser::scopeSize; ++i)
+    {
+        const auto x = area.getX() + (float) i * xScale;
+        const auto y = area.getCentreY() - juce::jlimit (-1.0f, 1.0f, frame.scope[(size_t) i]) * area.getHeight() * 0.5f;
+
+        if (i == 0)
+            trace.startNewSubPath (x, y);
+        else
+            trace.lineTo (x, y);
+    }
+
+    g.setColour (juce::Colours::lightgreen);
+    g.strokePath (trace, juce::PathStrokeType (1.0f));
+}
+
+void TelemetryView::paintSpectrum (juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    g.setColour (juce::Colours::darkgrey);
+    g.drawRect (area);
+
+    // Log frequency from 20 Hz to Nyquist, dB from minDecibels to 0
+    const auto nyquist = (float) frame.sampleRate * 0.5f;
+    const auto binWidth = nyquist / (float) TelemetryAnalyser::numBins;
+    const auto logRange = std::log (nyquist / spectrumLowestFrequency);
+
+    auto toY = [&] (float decibels)
+    {
+        return juce::jmap (juce::jlimit (minDecibels, 0.0f, decibels), minDecibels, 0.0f, area.getBottom(), area.getY());
+    };
+
+    juce::Path curve;
+    float lastX = -1.0f;
+
+    for (int bin = 1; bin < TelemetryAnalyser::numBins; ++bin)
+    {
+        const auto frequency = (float) bin * binWidth;
+
+        if (frequency < spectrumLowestFrequency)
+            continue;
+
+        const auto x = area.getX() + area.getWidth() * std::log (frequency / spectrumLowestFrequency) / logRange;
+        const auto y = toY (frame.spectrum[(size_t) bin]);
+
+        // High bins crowd into single pixels, one point each is plenty
+        if (curve.isEmpty())
+            curve.startNewSubPath (x, y);
+        else if (x - lastX >= 1.0f)
+            curve.lineTo (x, y);
+        else
+            continue;
+
+        lastX = x;
+    }
+
+    g.setColour (juce::Colours::skyblue);
+    g.strokePath (curve, juce::PathStrokeType (1.0f));
+}
+
+void TelemetryView::paintMeter (juce::Graphics& g, juce::Rectangle<float> area, int channel) const
+{
+    g.setColour (juce::Colours::darkgrey);
+    g.drawRect (area);
+
+    auto toHeight = [&] (float decibels)
+    {
+        return area.getHeight() * (juce::jlimit (minDecibels, 0.0f, decibels) - minDecibels) / -minDecibels;
+    };
+
+    g.setColour (juce::Colours::seagreen);
+    g.fillRect (area.withTop (area.getBottom() - toHeight (displayedRms[channel])));
+
+    g.setColour (displayedPeak[channel] >= 0.0f ? juce::Colours::red : juce::Colours::yellow);
+    g.fillRect (area.withTop (area.getBottom() - toHeight (displayedPeak[channel])).withHeight (2.0f));
+}
+
+void TelemetryView::paintVoiceStatus (juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    const auto& voices = frame.voices;
+
+    g.setColour (juce::Colours::white);
+    g.setFont (12.0f);
+    g.drawText (juce::String (voices.activeVoices) + " voices   " + getStageName (voices.stage),
+                area.removeFromLeft (area.getWidth() * 0.5f), juce::Justification::centredLeft);
+
+    // Envelope level of the newest voice
+    area = area.reduced (0.0f, 6.0f);
+    g.setColour (juce::Colours::darkgrey);
+    g.drawRect (area);
+    g.setColour (juce::Colours::orange);
+    g.fillRect (area.withWidth (area.getWidth() * juce::jlimit (0.0f, 1.0f, voices.envelopeLevel)));
+}
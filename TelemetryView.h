@@ -0,0 +1,39 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "AudioTelemetry.h"
+
+//==============================================================================
+/** Scope, spectrum, level meters and envelope state of the processor's output.
+
+    Runs a TelemetryAnalyser for as long as it exists, and repaints only when
+    the analyser has a new frame, at most framesPerSecond times a second.
+*/
+class TelemetryView final : public juce::Component,
+                            private juce::Timer
+{
+public:
+    explicit TelemetryView (TelemetryChannel& channel);
+
+    void paint (juce::Graphics&) override;
+
+    static constexpr int framesPerSecond = 30;
+
+private:
+    void timerCallback() override;
+
+    void paintScope (juce::Graphics&, juce::Rectangle<float> area) const;
+    void paintSpectrum (juce::Graphics&, juce::Rectangle<float> area) const;
+    void paintMeter (juce::Graphics&, juce::Rectangle<float> area, int channel) const;
+    void paintVoiceStatus (juce::Graphics&, juce::Rectangle<float> area) const;
+
+    TelemetryAnalyser analyser;
+    TelemetryAnalyser::Frame frame;
+
+    // Meter ballistics, in dB
+    float displayedPeak[2] { -100.0f, -100.0f };
+    float displayedRms[2] { -100.0f, -100.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TelemetryView)
+};
@@ -0,0 +1,548 @@
+#include "VoiceKernel.h"
+
+namespace
+{
+    //==============================================================================
+    /** A plain array with the subset of the juce::dsp::SIMDRegister interface the
+        kernel uses. Every operation mirrors what the vector instructions do lane
+        by lane, including min/max returning the second operand on ties.
+    */
+    template <size_t N>
+    struct ScalarRegister
+    {
+        struct vMaskType { bool bits[N]; };
+
+        float v[N];
+
+        static constexpr size_t size()  { return N; }
+
+        static ScalarRegister expand (float s)
+        {
+            ScalarRegister r;
+            for (size_t i = 0; i < N; ++i) r.v[i] = s;
+            return r;
+        }
+
+        static ScalarRegister fromRawArray (const float* a)
+        {
+            ScalarRegister r;
+            for (size_t i = 0; i < N; ++i) r.v[i] = a[i];
+            return r;
+        }
+
+        void copyToRawArray (float* a) const
+        {
+            for (size_t i = 0; i < N; ++i) a[i] = v[i];
+        }
+
+        ScalarRegister operator+ (ScalarRegister o) const   { ScalarRegister r; for (size_t i = 0; i < N; ++i) r.v[i] = v[i] + o.v[i]; return r; }
+        ScalarRegister operator- (ScalarRegister o) const   { ScalarRegister r; for (size_t i = 0; i < N; ++i) r.v[i] = v[i] - o.v[i]; return r; }
+        ScalarRegister operator* (ScalarRegister o) const   { ScalarRegister r; for (size_t i = 0; i < N; ++i) r.v[i] = v[i] * o.v[i]; return r; }
+        ScalarRegister operator+ (float s) const            { return *this + expand (s); }
+        ScalarRegister operator- (float s) const            { return *this - expand (s); }
+        ScalarRegister operator* (float s) const            { return *this * expand (s); }
+
+        ScalarRegister operator& (vMaskType m) const
+        {
+            ScalarRegister r;
+            for (size_t i = 0; i < N; ++i) r.v[i] = m.bits[i] ? v[i] : 0.0f;
+            return r;
+        }
+
+        static ScalarRegister min (ScalarRegister a, ScalarRegister b)  { ScalarRegister r; for (size_t i = 0; i < N; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+        static ScalarRegister max (ScalarRegister a, ScalarRegister b)  { ScalarRegister r; for (size_t i = 0; i < N; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+        static ScalarRegister abs (ScalarRegister a)                    { ScalarRegister r; for (size_t i = 0; i < N; ++i) r.v[i] = std::abs (a.v[i]); return r; }
+
+        static vMaskType greaterThanOrEqual (ScalarRegister a, ScalarRegister b)
+        {
+            vMaskType m;
+            for (size_t i = 0; i < N; ++i) m.bits[i] = a.v[i] >= b.v[i];
+            return m;
+        }
+    };
+
+    //==============================================================================
+    /** Linear interpolation into each lane's own table. There is no gather in
+        the register interface, so the lanes are looked up one at a time.
+    */
+    template <typename Vec>
+    inline Vec tableLookup (Vec phase, const float* const* tables)
+    {
+        constexpr auto width = Vec::size();
+        alignas (32) float phases[width];
+        alignas (32) float values[width];
+
+        phase.copyToRawArray (phases);
+
+        for (size_t lane = 0; lane < width; ++lane)
+        {
+            const auto position = phases[lane] * (float) Wavetable::tableSize;
+            const auto index = (int) position;
+            const auto frac = position - (float) index;
+            const auto* table = tables[lane];
+            values[lane] = table[index] + frac * (table[index + 1] - table[index]);
+        }
+
+        return Vec::fromRawArray (values);
+    }
+
+    //==============================================================================
+    /** Where an oscillator's samples come from. Sine has a single harmonic, so
+        it skips the tables and is evaluated directly, every other shape reads
+        its band-limited table, and those only differ in the table's contents.
+    */
+    enum class Source
+    {
+        sineDraft,
+        sineExact,
+        table,
+        any         // decided per sample, from the wave type and accuracy
+    };
+
+    constexpr int numSources = 3;       // not counting any
+    constexpr int numFilterTypes = 3;
+    constexpr int anyFilter = -1;       // filter type argument that reads params.filterType instead
+
+    Source getSource (int waveType, FastMath::Accuracy accuracy)
+    {
+        if (waveType != WavetableBank::sine)
+            return Source::table;
+
+        return accuracy == FastMath::Accuracy::draft ? Source::sineDraft : Source::sineExact;
+    }
+
+    template <Source source, typename Vec>
+    inline Vec oscillator (Vec phase, int waveType, const float* const* tables, FastMath::Accuracy accuracy)
+    {
+        if constexpr (source == Source::sineDraft)
+            return FastMath::sin2Pi<FastMath::Accuracy::draft> (phase);
+        else if constexpr (source == Source::sineExact)
+            return FastMath::sin2Pi<FastMath::Accuracy::exact> (phase);
+        else if constexpr (source == Source::table)
+            return tableLookup (phase, tables);
+        else
+            return waveType != WavetableBank::sine ? tableLookup (phase, tables)
+                 : accuracy == FastMath::Accuracy::draft ? FastMath::sin2Pi<FastMath::Accuracy::draft> (phase)
+                                                         : FastMath::sin2Pi<FastMath::Accuracy::exact> (phase);
+    }
+
+    template <typename Vec>
+    inline Vec wrapPhase (Vec phase)
+    {
+        const auto one = Vec::expand (1.0f);
+        return phase - (one & Vec::greaterThanOrEqual (phase, one));
+    }
+
+    /** One sample of the TPT state variable filter, returning the output picked
+        by filterType, or by runtimeType for anyFilter.
+    */
+    template <int filterType, typename Vec>
+    inline Vec filterSample (Vec x, Vec& s1, Vec& s2, Vec g, Vec gR2, Vec h, int runtimeType)
+    {
+        const auto yHP = h * (x - s1 * gR2 - s2);
+        const auto yBP = yHP * g + s1;
+        s1 = yHP * g + yBP;
+        const auto yLP = yBP * g + s2;
+        s2 = yBP * g + yLP;
+
+        if constexpr (filterType == 0)
+            return yLP;
+        else if constexpr (filterType == 1)
+            return yBP;
+        else if constexpr (filterType == 2)
+            return yHP;
+        else
+            return runtimeType == 0 ? yLP
+                 : runtimeType == 1 ? yBP
+                                    : yHP;
+    }
+
+    /** The envelope can only travel from its current level towards its target,
+        so clamping to that interval stops it exactly at the stage boundary.
+    */
+    template <typename Vec>
+    inline Vec envelopeSample (Vec level, Vec rate, Vec lowest, Vec highest)
+    {
+        return Vec::max (lowest, Vec::min (highest, level + rate));
+    }
+
+    //==============================================================================
+    /** Sums the unison copies of both oscillators for one sample, weighted by
+        each copy's left and right gains, and advances their phases.
+    */
+    template <typename Vec, bool stereo, Source source1, Source source2>
+    inline void oscillatorStack (VoiceLanes& lanes, int firstLane, const VoiceKernelParameters& params,
+                                 Vec inc1, Vec inc2, Vec gain1, Vec gain2, Vec& left, Vec& right)
+    {
+        for (int copy = 0; copy < params.unisonVoices; ++copy)
+        {
+            auto* phase1 = lanes.osc1Phase[copy] + firstLane;
+            auto* phase2 = lanes.osc2Phase[copy] + firstLane;
+            const auto p1 = Vec::fromRawArray (phase1);
+            const auto p2 = Vec::fromRawArray (phase2);
+
+            const auto y = oscillator<source1> (p1, params.osc1WaveType, lanes.osc1Table + firstLane, params.accuracy) * gain1
+                         + oscillator<source2> (p2, params.osc2WaveType, lanes.osc2Table + firstLane, params.accuracy) * gain2;
+
+            left = left + y * params.unisonLeft[copy];
+
+            if (stereo)
+                right = right + y * params.unisonRight[copy];
+
+            wrapPhase (p1 + inc1 * params.unisonRatio[copy]).copyToRawArray (phase1);
+            wrapPhase (p2 + inc2 * params.unisonRatio[copy]).copyToRawArray (phase2);
+        }
+    }
+
+    //==============================================================================
+    /** How a lane group's output reaches the two sides. */
+    enum class Output
+    {
+        mono,           // left only, no pan
+        panned,         // one filter, panned per voice
+        dual            // a filter per side, then panned
+    };
+
+    /** Renders one lane group for numSamples, adding each lane's output into
+        laneLeft and laneRight, which are laid out as [sample][lane].
+
+        The oscillator sources and the filter type are template arguments, so
+        each combination compiles to its own loop with no branches on them.
+    */
+    template <typename Vec, Output output, Source source1, Source source2, int filterType>
+    void renderGroup (VoiceLanes& lanes, int firstLane, const VoiceKernelParameters& params,
+                      float* laneLeft, float* laneRight, int numSamples)
+    {
+        constexpr auto width = static_cast<int> (Vec::size());
+        constexpr auto dual = output == Output::dual;
+
+        auto inc1 = Vec::fromRawArray (lanes.osc1Increment + firstLane);
+        auto inc2 = Vec::fromRawArray (lanes.osc2Increment + firstLane);
+        const auto ramp1 = Vec::fromRawArray (lanes.osc1IncrementRamp + firstLane);
+        const auto ramp2 = Vec::fromRawArray (lanes.osc2IncrementRamp + firstLane);
+        const auto nyquist = Vec::expand (0.5f);
+        auto gain1 = Vec::fromRawArray (lanes.osc1Gain + firstLane);
+        auto gain2 = Vec::fromRawArray (lanes.osc2Gain + firstLane);
+        const auto gainRamp1 = Vec::fromRawArray (lanes.osc1GainRamp + firstLane);
+        const auto gainRamp2 = Vec::fromRawArray (lanes.osc2GainRamp + firstLane);
+
+        auto level = Vec::fromRawArray (lanes.envelopeLevel + firstLane);
+        const auto rate = Vec::fromRawArray (lanes.envelopeRate + firstLane);
+        const auto target = Vec::fromRawArray (lanes.envelopeTarget + firstLane);
+        const auto lowest = Vec::min (level, target);
+        const auto highest = Vec::max (level, target);
+
+        const auto panLeft = Vec::fromRawArray (lanes.panLeft + firstLane);
+        const auto panRight = Vec::fromRawArray (lanes.panRight + firstLane);
+
+        auto s1 = Vec::fromRawArray (lanes.ic1eq[0] + firstLane);
+        auto s2 = Vec::fromRawArray (lanes.ic2eq[0] + firstLane);
+        auto s1Right = Vec::fromRawArray (lanes.ic1eq[1] + firstLane);
+        auto s2Right = Vec::fromRawArray (lanes.ic2eq[1] + firstLane);
+
+        auto g = Vec::fromRawArray (lanes.filterG[0] + firstLane);
+        auto gR2 = Vec::fromRawArray (lanes.filterGR2[0] + firstLane);
+        auto h = Vec::fromRawArray (lanes.filterH[0] + firstLane);
+        const auto gIncrement = Vec::fromRawArray (lanes.filterGRamp[0] + firstLane);
+        const auto gR2Increment = Vec::fromRawArray (lanes.filterGR2Ramp[0] + firstLane);
+        const auto hIncrement = Vec::fromRawArray (lanes.filterHRamp[0] + firstLane);
+
+        auto gRight = Vec::fromRawArray (lanes.filterG[1] + firstLane);
+        auto gR2Right = Vec::fromRawArray (lanes.filterGR2[1] + firstLane);
+        auto hRight = Vec::fromRawArray (lanes.filterH[1] + firstLane);
+        const auto gRightIncrement = Vec::fromRawArray (lanes.filterGRamp[1] + firstLane);
+        const auto gR2RightIncrement = Vec::fromRawArray (lanes.filterGR2Ramp[1] + firstLane);
+        const auto hRightIncrement = Vec::fromRawArray (lanes.filterHRamp[1] + firstLane);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            auto x = Vec::expand (0.0f);
+            auto xRight = Vec::expand (0.0f);
+            oscillatorStack<Vec, dual, source1, source2> (lanes, firstLane, params, inc1, inc2, gain1, gain2, x, xRight);
+
+            // Both filters step in the same iteration, so their dependency
+            // chains overlap rather than running back to back
+            const auto filtered = filterSample<filterType> (x, s1, s2, g, gR2, h, params.filterType);
+            const auto filteredRight = dual ? filterSample<filterType> (xRight, s1Right, s2Right, gRight, gR2Right, hRight, params.filterType)
+                                            : filtered;
+            level = envelopeSample (level, rate, lowest, highest);
+
+            auto* out = laneLeft + sample * width;
+
+            if (output == Output::mono)
+            {
+                (Vec::fromRawArray (out) + filtered * level).copyToRawArray (out);
+            }
+            else
+            {
+                auto* outRight = laneRight + sample * width;
+                (Vec::fromRawArray (out) + filtered * level * panLeft).copyToRawArray (out);
+                (Vec::fromRawArray (outRight) + filteredRight * level * panRight).copyToRawArray (outRight);
+            }
+
+            inc1 = Vec::min (inc1 + ramp1, nyquist);
+            inc2 = Vec::min (inc2 + ramp2, nyquist);
+            gain1 = gain1 + gainRamp1;
+            gain2 = gain2 + gainRamp2;
+
+            g = g + gIncrement;
+            gR2 = gR2 + gR2Increment;
+            h = h + hIncrement;
+
+            if (dual)
+            {
+                gRight = gRight + gRightIncrement;
+                gR2Right = gR2Right + gR2RightIncrement;
+                hRight = hRight + hRightIncrement;
+            }
+        }
+
+        inc1.copyToRawArray (lanes.osc1Increment + firstLane);
+        inc2.copyToRawArray (lanes.osc2Increment + firstLane);
+        gain1.copyToRawArray (lanes.osc1Gain + firstLane);
+        gain2.copyToRawArray (lanes.osc2Gain + firstLane);
+        level.copyToRawArray (lanes.envelopeLevel + firstLane);
+        s1.copyToRawArray (lanes.ic1eq[0] + firstLane);
+        s2.copyToRawArray (lanes.ic2eq[0] + firstLane);
+        g.copyToRawArray (lanes.filterG[0] + firstLane);
+        gR2.copyToRawArray (lanes.filterGR2[0] + firstLane);
+        h.copyToRawArray (lanes.filterH[0] + firstLane);
+
+        if (dual)
+        {
+            s1Right.copyToRawArray (lanes.ic1eq[1] + firstLane);
+            s2Right.copyToRawArray (lanes.ic2eq[1] + firstLane);
+            gRight.copyToRawArray (lanes.filterG[1] + firstLane);
+            gR2Right.copyToRawArray (lanes.filterGR2[1] + firstLane);
+            hRight.copyToRawArray (lanes.filterH[1] + firstLane);
+        }
+    }
+
+    /** Runs a single stage of renderGroup on its own, so it can be profiled.
+        The filter stage is fed with the oscillator 1 phase ramp rather than the
+        oscillators, to keep their cost out of the measurement. Only the left
+        side is rendered.
+    */
+    template <typename Vec>
+    void renderStageGroup (VoiceKernel::Stage stage, VoiceLanes& lanes, int firstLane,
+                           const VoiceKernelParameters& params, float* laneOutput, int numSamples)
+    {
+        constexpr auto width = static_cast<int> (Vec::size());
+
+        auto inc1 = Vec::fromRawArray (lanes.osc1Increment + firstLane);
+        auto inc2 = Vec::fromRawArray (lanes.osc2Increment + firstLane);
+        const auto ramp1 = Vec::fromRawArray (lanes.osc1IncrementRamp + firstLane);
+        const auto ramp2 = Vec::fromRawArray (lanes.osc2IncrementRamp + firstLane);
+        const auto nyquist = Vec::expand (0.5f);
+        auto gain1 = Vec::fromRawArray (lanes.osc1Gain + firstLane);
+        auto gain2 = Vec::fromRawArray (lanes.osc2Gain + firstLane);
+        const auto gainRamp1 = Vec::fromRawArray (lanes.osc1GainRamp + firstLane);
+        const auto gainRamp2 = Vec::fromRawArray (lanes.osc2GainRamp + firstLane);
+
+        auto level = Vec::fromRawArray (lanes.envelopeLevel + firstLane);
+        const auto rate = Vec::fromRawArray (lanes.envelopeRate + firstLane);
+        const auto target = Vec::fromRawArray (lanes.envelopeTarget + firstLane);
+        const auto lowest = Vec::min (level, target);
+        const auto highest = Vec::max (level, target);
+
+        auto s1 = Vec::fromRawArray (lanes.ic1eq[0] + firstLane);
+        auto s2 = Vec::fromRawArray (lanes.ic2eq[0] + firstLane);
+        const auto g = Vec::fromRawArray (lanes.filterG[0] + firstLane);
+        const auto gR2 = Vec::fromRawArray (lanes.filterGR2[0] + firstLane);
+        const auto h = Vec::fromRawArray (lanes.filterH[0] + firstLane);
+
+        auto phase = Vec::fromRawArray (lanes.osc1Phase[0] + firstLane);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            auto y = Vec::expand (0.0f);
+
+            switch (stage)
+            {
+                case VoiceKernel::Stage::oscillators:
+                {
+                    auto unused = Vec::expand (0.0f);
+                    oscillatorStack<Vec, false, Source::any, Source::any> (lanes, firstLane, params, inc1, inc2, gain1, gain2, y, unused);
+                    break;
+                }
+
+                case VoiceKernel::Stage::filter:
+                    y = filterSample<anyFilter> (phase, s1, s2, g, gR2, h, params.filterType);
+                    phase = wrapPhase (phase + inc1);
+                    break;
+
+                case VoiceKernel::Stage::envelope:
+                case VoiceKernel::Stage::complete:
+                default:
+                    level = envelopeSample (level, rate, lowest, highest);
+                    y = level;
+                    break;
+            }
+
+            auto* out = laneOutput + sample * width;
+            (Vec::fromRawArray (out) + y).copyToRawArray (out);
+
+            inc1 = Vec::min (inc1 + ramp1, nyquist);
+            inc2 = Vec::min (inc2 + ramp2, nyquist);
+            gain1 = gain1 + gainRamp1;
+            gain2 = gain2 + gainRamp2;
+        }
+
+        inc1.copyToRawArray (lanes.osc1Increment + firstLane);
+        inc2.copyToRawArray (lanes.osc2Increment + firstLane);
+        gain1.copyToRawArray (lanes.osc1Gain + firstLane);
+        gain2.copyToRawArray (lanes.osc2Gain + firstLane);
+        level.copyToRawArray (lanes.envelopeLevel + firstLane);
+        s1.copyToRawArray (lanes.ic1eq[0] + firstLane);
+        s2.copyToRawArray (lanes.ic2eq[0] + firstLane);
+
+        if (stage == VoiceKernel::Stage::filter)
+            phase.copyToRawArray (lanes.osc1Phase[0] + firstLane);
+    }
+
+    /** Fixed pairwise reduction order, shared by both implementations. */
+    template <int width>
+    void reduceLanes (const float* laneOutput, float* output, int numSamples)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const auto* lane = laneOutput + sample * width;
+            auto sum = 0.0f;
+
+            for (int i = 0; i < width; i += 2)
+                sum += lane[i] + lane[i + 1];
+
+            output[sample] += sum;
+        }
+    }
+
+    //==============================================================================
+    using GroupRenderer = void (*) (VoiceLanes&, int, const VoiceKernelParameters&, float*, float*, int);
+
+    /** Every specialisation of renderGroup for one output, indexed by
+        (source1 * numSources + source2) * numFilterTypes + filterType.
+    */
+    template <typename Vec, Output output>
+    struct SpecialisedKernels
+    {
+        template <size_t... index>
+        static constexpr std::array<GroupRenderer, sizeof... (index)> make (std::index_sequence<index...>)
+        {
+            return { { &renderGroup<Vec, output,
+                                    static_cast<Source> (index / (numSources * numFilterTypes)),
+                                    static_cast<Source> ((index / numFilterTypes) % numSources),
+                                    static_cast<int> (index % numFilterTypes)>... } };
+        }
+
+        static constexpr auto table = make (std::make_index_sequence<numSources * numSources * numFilterTypes>());
+    };
+
+    template <typename Vec, Output output>
+    GroupRenderer pickKernel (const VoiceKernelParameters& params, VoiceKernel::Dispatch dispatch)
+    {
+        if (dispatch == VoiceKernel::Dispatch::generic)
+            return &renderGroup<Vec, output, Source::any, Source::any, anyFilter>;
+
+        const auto source1 = static_cast<int> (getSource (params.osc1WaveType, params.accuracy));
+        const auto source2 = static_cast<int> (getSource (params.osc2WaveType, params.accuracy));
+        const auto filterType = juce::jlimit (0, numFilterTypes - 1, params.filterType);
+
+        return SpecialisedKernels<Vec, output>::table[(size_t) ((source1 * numSources + source2) * numFilterTypes + filterType)];
+    }
+
+    template <typename Vec>
+    void renderAllGroups (VoiceKernel::Stage stage, VoiceKernel::Dispatch dispatch, VoiceLanes& lanes,
+                          const VoiceKernelParameters& params, juce::uint32 activeGroups,
+                          float* outputLeft, float* outputRight, int numSamples)
+    {
+        constexpr auto width = static_cast<int> (Vec::size());
+        constexpr auto numGroups = VoiceLanes::numLanes / width;
+
+        // The settings the kernels are specialised on hold for the whole call,
+        // so the kernel is picked once here rather than per sample
+        GroupRenderer kernel = nullptr;
+
+        if (stage == VoiceKernel::Stage::complete)
+            kernel = outputRight == nullptr ? pickKernel<Vec, Output::mono> (params, dispatch)
+                   : params.secondFilter    ? pickKernel<Vec, Output::dual> (params, dispatch)
+                                            : pickKernel<Vec, Output::panned> (params, dispatch);
+
+        alignas (32) float laneLeft[VoiceKernel::chunkSize * width];
+        alignas (32) float laneRight[VoiceKernel::chunkSize * width];
+
+        for (int start = 0; start < numSamples; start += VoiceKernel::chunkSize)
+        {
+            const auto chunk = juce::jmin (VoiceKernel::chunkSize, numSamples - start);
+            std::fill (laneLeft, laneLeft + chunk * width, 0.0f);
+
+            if (outputRight != nullptr)
+                std::fill (laneRight, laneRight + chunk * width, 0.0f);
+
+            for (int group = 0; group < numGroups; ++group)
+            {
+                if ((activeGroups & (1u << group)) == 0)
+                    continue;
+
+                if (kernel != nullptr)
+                    kernel (lanes, group * width, params, laneLeft, outputRight != nullptr ? laneRight : nullptr, chunk);
+                else
+                    renderStageGroup<Vec> (stage, lanes, group * width, params, laneLeft, chunk);
+            }
+
+            reduceLanes<width> (laneLeft, outputLeft + start, chunk);
+
+            if (outputRight != nullptr)
+                reduceLanes<width> (laneRight, outputRight + start, chunk);
+        }
+    }
+}
+
+//==============================================================================
+VoiceKernel::Implementation VoiceKernel::getBestImplementation()
+{
+   #if JUCE_USE_SIMD
+    #if JUCE_INTEL
+     if (juce::SystemStats::hasSSE2())
+         return Implementation::simd;
+    #elif JUCE_ARM
+     if (juce::SystemStats::hasNeon())
+         return Implementation::simd;
+    #endif
+   #endif
+
+    return Implementation::scalar;
+}
+
+void VoiceKernel::render (Implementation implementation, VoiceLanes& lanes, const VoiceKernelParameters& params,
+                          juce::uint32 activeGroups, float* outputLeft, float* outputRight, int numSamples,
+                          Dispatch dispatch)
+{
+    renderAll (implementation, Stage::complete, dispatch, lanes, params, activeGroups, outputLeft, outputRight, numSamples);
+}
+
+void VoiceKernel::renderStage (Implementation implementation, Stage stage, VoiceLanes& lanes,
+                               const VoiceKernelParameters& params, juce::uint32 activeGroups,
+                               float* output, int numSamples)
+{
+    renderAll (implementation, stage, Dispatch::generic, lanes, params, activeGroups, output, nullptr, numSamples);
+}
+
+void VoiceKernel::renderAll (Implementation implementation, Stage stage, Dispatch dispatch, VoiceLanes& lanes,
+                             const VoiceKernelParameters& params, juce::uint32 activeGroups,
+                             float* outputLeft, float* outputRight, int numSamples)
+{
+    if (activeGroups == 0)
+        return;
+
+   #if JUCE_USE_SIMD
+    if (implementation == Implementation::simd)
+    {
+        renderAllGroups<juce::dsp::SIMDRegister<float>> (stage, dispatch, lanes, params, activeGroups, outputLeft, outputRight, numSamples);
+        return;
+    }
+   #else
+    juce::ignoreUnused (implementation);
+   #endif
+
+    renderAllGroups<ScalarRegister<static_cast<size_t> (lanesPerGroup)>> (stage, dispatch, lanes, params, activeGroups, outputLeft, outputRight, numSamples);
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "FastMath.h"
+#include "FilterControl.h"
+#include "WavetableBank.h"
+
+//==============================================================================
+/** Structure-of-arrays DSP state for every voice in the pool.
+
+    Lane i holds voice i. The arrays are aligned and padded so that groups of
+    lanes can be loaded straight into SIMD registers. Each unison copy of an
+    oscillator has its own row of phases, so the copies of a lane group are
+    stepped through one register at a time.
+
+    Mix levels and filter coefficients are per lane too, so modulation can
+    move them voice by voice. Like the increments, they carry a per-sample ramp
+    and the kernel writes back where they ended up.
+*/
+struct VoiceLanes
+{
+    static constexpr int numLanes = 16;
+    static constexpr int maxUnison = 16;
+
+    alignas (32) float osc1Phase[maxUnison][numLanes] {};   // [copy][lane], normalised, [0, 1)
+    alignas (32) float osc2Phase[maxUnison][numLanes] {};
+    alignas (32) float osc1Increment[numLanes] {};
+    alignas (32) float osc2Increment[numLanes] {};
+    alignas (32) float osc1IncrementRamp[numLanes] {};  // per-sample change of the increment
+    alignas (32) float osc2IncrementRamp[numLanes] {};
+    const float* osc1Table[numLanes] {};            // band-limited level picked per control tick
+    const float* osc2Table[numLanes] {};
+    alignas (32) float osc1Gain[numLanes] {};       // mix level with the output gain folded in
+    alignas (32) float osc2Gain[numLanes] {};
+    alignas (32) float osc1GainRamp[numLanes] {};
+    alignas (32) float osc2GainRamp[numLanes] {};
+
+    alignas (32) float envelopeLevel[numLanes] {};
+    alignas (32) float envelopeRate[numLanes] {};   // per-sample step, signed
+    alignas (32) float envelopeTarget[numLanes] {};
+
+    alignas (32) float ic1eq[2][numLanes] {};       // TPT state variable filter state, left and right
+    alignas (32) float ic2eq[2][numLanes] {};
+    alignas (32) float filterG[2][numLanes] {};     // coefficients, see FilterCoefficients
+    alignas (32) float filterGR2[2][numLanes] {};
+    alignas (32) float filterH[2][numLanes] {};
+    alignas (32) float filterGRamp[2][numLanes] {}; // per-sample ramp towards the next control point
+    alignas (32) float filterGR2Ramp[2][numLanes] {};
+    alignas (32) float filterHRamp[2][numLanes] {};
+
+    alignas (32) float panLeft[numLanes] {};        // gain of each voice on either side, after the filter
+    alignas (32) float panRight[numLanes] {};
+
+    FilterCoefficients getFilter (int side, int lane) const noexcept
+    {
+        return { filterG[side][lane], filterGR2[side][lane], filterH[side][lane] };
+    }
+
+    FilterCoefficients getFilterRamp (int side, int lane) const noexcept
+    {
+        return { filterGRamp[side][lane], filterGR2Ramp[side][lane], filterHRamp[side][lane] };
+    }
+
+    void setFilter (int side, int lane, const FilterCoefficients& c, const FilterCoefficients& ramp) noexcept
+    {
+        filterG[side][lane] = c.g;
+        filterGR2[side][lane] = c.gR2;
+        filterH[side][lane] = c.h;
+        filterGRamp[side][lane] = ramp.g;
+        filterGR2Ramp[side][lane] = ramp.gR2;
+        filterHRamp[side][lane] = ramp.h;
+    }
+};
+
+//==============================================================================
+/** Per-segment settings shared by all lanes. */
+struct VoiceKernelParameters
+{
+    int osc1WaveType = 0;
+    int osc2WaveType = 0;
+    FastMath::Accuracy accuracy = FastMath::Accuracy::exact;  // of the sine oscillator
+
+    int unisonVoices = 1;
+    float unisonRatio[VoiceLanes::maxUnison] { 1.0f };  // increment multiplier of each copy
+    float unisonLeft[VoiceLanes::maxUnison] { 1.0f };   // gain of each copy, pan and normalisation included
+    float unisonRight[VoiceLanes::maxUnison] { 1.0f };
+
+    int filterType = 0;         // 0 = lowpass, 1 = bandpass, 2 = highpass
+
+    // Stereo output either pans the left filter's output, or, when the two
+    // sides differ before or inside the filter, runs a second one for the right
+    // with the lanes' right side coefficients
+    bool secondFilter = false;
+};
+
+//==============================================================================
+/** Renders groups of voice lanes packed across SIMD registers.
+
+    The same template produces both the vector path (juce::dsp::SIMDRegister)
+    and a scalar fallback with identical lane width, operation order and
+    horizontal reduction, so the two produce bit-identical output.
+*/
+class VoiceKernel
+{
+public:
+    enum class Implementation
+    {
+        scalar,
+        simd
+    };
+
+    /** The pieces of the kernel, which can be run on their own for profiling. */
+    enum class Stage
+    {
+        complete,
+        oscillators,
+        filter,
+        envelope
+    };
+
+    /** How render() handles the oscillator shapes, sine accuracy and filter
+        type, which stay the same for a whole call.
+    */
+    enum class Dispatch
+    {
+        specialised,    // a kernel compiled for the combination, picked once per call
+        generic         // one kernel for all of them, branching every sample
+    };
+
+    /** Picks the vector path when this build has one and the CPU supports it. */
+    static Implementation getBestImplementation();
+
+    /** Number of lanes processed per register. */
+    static constexpr int getLanesPerGroup()     { return lanesPerGroup; }
+
+    /** Adds numSamples of every lane group flagged in activeGroups into the
+        outputs. Lane groups are numbered in units of getLanesPerGroup().
+
+        With outputRight set to nullptr only the left side is rendered, without
+        the voices' pan. Otherwise each voice is panned after the filter, and
+        the right side only gets a filter of its own if params.secondFilter
+        is set.
+
+        Both dispatch modes produce bit-identical output; generic is only there
+        to measure what the specialisation gains.
+    */
+    static void render (Implementation implementation,
+                        VoiceLanes& lanes,
+                        const VoiceKernelParameters& params,
+                        juce::uint32 activeGroups,
+                        float* outputLeft,
+                        float* outputRight,
+                        int numSamples,
+                        Dispatch dispatch = Dispatch::specialised);
+
+    /** Like render(), but runs only one stage of the voice and adds its raw
+        output. This is for timing the stages in isolation; audio should always
+        go through render().
+    */
+    static void renderStage (Implementation implementation,
+                             Stage stage,
+                             VoiceLanes& lanes,
+                             const VoiceKernelParameters& params,
+                             juce::uint32 activeGroups,
+                             float* output,
+                             int numSamples);
+
+    static constexpr int chunkSize = 32;
+
+private:
+    static void renderAll (Implementation, Stage, Dispatch, VoiceLanes&, const VoiceKernelParameters&,
+                           juce::uint32 activeGroups, float* outputLeft, float* outputRight, int numSamples);
+
+   #if JUCE_USE_SIMD
+    static constexpr int lanesPerGroup = static_cast<int> (juce::dsp::SIMDRegister<float>::size());
+   #else
+    static constexpr int lanesPerGroup = 4;
+   #endif
+
+    static_assert (VoiceLanes::numLanes % lanesPerGroup == 0, "Voice lanes must fill whole registers");
+};
@@ -0,0 +1,149 @@
+#include "VoiceThreadPool.h"
+
+//==============================================================================
+class VoiceThreadPool::Worker final : public juce::Thread
+{
+public:
+    explicit Worker (VoiceThreadPool& p) : juce::Thread ("Voice Worker"), pool (p) {}
+
+    void run() override
+    {
+        // Denormal handling is per thread, so the workers need the same as
+        // the audio thread
+        const juce::ScopedNoDenormals noDenormals;
+
+        auto lastWork = juce::Time::getMillisecondCounter();
+
+        while (! threadShouldExit())
+        {
+            if (pool.runPendingTask())
+            {
+                lastWork = juce::Time::getMillisecondCounter();
+                continue;
+            }
+
+            // Blocks arrive every few milliseconds while audio is running, so
+            // keep polling for a while before parking
+            if (juce::Time::getMillisecondCounter() - lastWork < spinMilliseconds)
+            {
+                juce::Thread::yield();
+                continue;
+            }
+
+            // A batch published after parked is set finds it set, and one
+            // published before it is seen here, so no batch goes unnoticed
+            parked.store (true);
+
+            if (! pool.hasPendingTask())
+                wait (-1);
+
+            parked.store (false);
+            lastWork = juce::Time::getMillisecondCounter();
+        }
+    }
+
+    /** Called by the pool for every new batch. */
+    void wakeIfParked()
+    {
+        if (parked.exchange (false))
+            notify();
+    }
+
+private:
+    static constexpr juce::uint32 spinMilliseconds = 200;
+
+    VoiceThreadPool& pool;
+    std::atomic<bool> parked { false };
+};
+
+//==============================================================================
+VoiceThreadPool::VoiceThreadPool() = default;
+
+VoiceThreadPool::~VoiceThreadPool()
+{
+    stop();
+}
+
+void VoiceThreadPool::start (int numWorkers, int samplesPerBlock, double sampleRate)
+{
+    stop();
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto worker = std::make_unique<Worker> (*this);
+
+        const auto options = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime (juce::jmax (1, samplesPerBlock), sampleRate);
+
+        if (! worker->startRealtimeThread (options))
+            worker->startThread (juce::Thread::Priority::highest);
+
+        workers.push_back (std::move (worker));
+    }
+}
+
+void VoiceThreadPool::stop()
+{
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (auto& worker : workers)
+        worker->stopThread (1000);
+
+    workers.clear();
+}
+
+//==============================================================================
+void VoiceThreadPool::run (Task task, void* context, int numTasks)
+{
+    if (numTasks <= 0)
+        return;
+
+    jassert (numTasks <= maxTasks);
+
+    // Every task of the previous batch has finished, so nobody is reading these
+    currentTask = task;
+    currentContext = context;
+    currentMonitor = RealtimeMonitor::getCurrent();
+    completed.store (0, std::memory_order_relaxed);
+
+    const auto generation = (state.load (std::memory_order_relaxed) >> 32) + 1;
+    state.store ((generation << 32) | ((juce::uint64) numTasks << 16));
+
+    for (auto& worker : workers)
+        worker->wakeIfParked();
+
+    while (runPendingTask())
+    {}
+
+    // Whatever is left is already running on a worker
+    while (completed.load (std::memory_order_acquire) < numTasks)
+    {}
+}
+
+bool VoiceThreadPool::hasPendingTask() const noexcept
+{
+    const auto current = state.load();
+    return (current & 0xffff) < ((current >> 16) & 0xffff);
+}
+
+bool VoiceThreadPool::runPendingTask()
+{
+    auto current = state.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto numTasks = (int) ((current >> 16) & 0xffff);
+        const auto next = (int) (current & 0xffff);
+
+        if (next >= numTasks)
+            return false;
+
+        if (state.compare_exchange_weak (current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            const RealtimeMonitor::WorkerScope realtimeScope (currentMonitor);
+            currentTask (currentContext, next);
+            completed.fetch_add (1, std::memory_order_release);
+            return true;
+        }
+    }
+}
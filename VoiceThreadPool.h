@@ -0,0 +1,64 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include "RealtimeMonitor.h"
+
+//==============================================================================
+/** A few real-time worker threads that help the audio thread with one batch of
+    independent tasks at a time.
+
+    The audio thread publishes a batch with run() and claims tasks from it
+    alongside the workers, so a task nobody else has picked up yet is simply
+    done by the caller. It only ever waits for tasks a worker is already in the
+    middle of.
+
+    Workers spin while batches keep coming. Once they've been idle for a while
+    they park until run() wakes them, so they cost nothing while playback is
+    stopped or the plugin bypassed. Only the first batch after that signals
+    them; it is mostly done by the caller alone, as the workers take a moment
+    to wake up.
+*/
+class VoiceThreadPool
+{
+public:
+    using Task = void (*) (void* context, int taskIndex);
+
+    VoiceThreadPool();
+    ~VoiceThreadPool();
+
+    /** Starts numWorkers threads, sized for blocks of the given length.
+        Call from the message thread, e.g. in prepareToPlay.
+    */
+    void start (int numWorkers, int samplesPerBlock, double sampleRate);
+    void stop();
+
+    int getNumWorkers() const noexcept      { return (int) workers.size(); }
+
+    /** Runs task (context, i) for every i in [0, numTasks) and returns when all
+        of them have finished. Only one thread may call this at a time.
+
+        Workers count against the caller's RealtimeMonitor while they run the
+        tasks, as if the caller had run them itself.
+    */
+    void run (Task task, void* context, int numTasks);
+
+    static constexpr int maxTasks = 0xffff;
+
+private:
+    class Worker;
+
+    bool hasPendingTask() const noexcept;
+    bool runPendingTask();
+
+    // generation (32 bits) | number of tasks (16 bits) | next unclaimed task (16 bits)
+    std::atomic<juce::uint64> state { 0 };
+    std::atomic<int> completed { 0 };
+    Task currentTask = nullptr;
+    void* currentContext = nullptr;
+    RealtimeMonitor* currentMonitor = nullptr;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    JUCE_DECLARE_NON_COPYABLE (VoiceThreadPool)
+};
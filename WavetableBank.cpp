@@ -0,0 +1,195 @@
+#include "WavetableBank.h"
+
+//==============================================================================
+Wavetable::Wavetable (const float* cycle, int numSamples, double maxNormalisedFrequency)
+    : tables ((size_t) numLevels * (tableSize + 1), 0.0f)
+{
+    juce::dsp::FFT fft (tableOrder);
+    std::vector<float> spectrum ((size_t) tableSize * 2, 0.0f);
+
+    // Resample the source cycle onto the table grid with linear interpolation
+    for (int i = 0; i < tableSize; ++i)
+    {
+        const auto position = (double) i * numSamples / tableSize;
+        const auto index = (int) position;
+        const auto frac = (float) (position - index);
+        const auto a = cycle[index % numSamples];
+        const auto b = cycle[(index + 1) % numSamples];
+        spectrum[(size_t) i] = a + frac * (b - a);
+    }
+
+    fft.performRealOnlyForwardTransform (spectrum.data());
+
+    std::vector<float> levelData (spectrum.size());
+
+    for (int level = 0; level < numLevels; ++level)
+    {
+        // The highest fundamental played from this level has an increment of
+        // 2^level / tableSize, so keep only the harmonics that stay below the limit
+        const auto topIncrement = (double) (1 << level) / tableSize;
+        const auto numHarmonics = juce::jlimit (1, tableSize / 2 - 1, (int) (maxNormalisedFrequency / topIncrement));
+
+        levelData = spectrum;
+
+        for (int bin = numHarmonics + 1; bin < tableSize - numHarmonics; ++bin)
+        {
+            levelData[(size_t) bin * 2] = 0.0f;
+            levelData[(size_t) bin * 2 + 1] = 0.0f;
+        }
+
+        fft.performRealOnlyInverseTransform (levelData.data());
+
+        auto* table = tables.data() + (size_t) level * (tableSize + 1);
+        std::copy (levelData.begin(), levelData.begin() + tableSize, table);
+        table[tableSize] = table[0];
+    }
+}
+
+const float* Wavetable::getTableForIncrement (float increment) const
+{
+    int exponent = 0;
+    const auto mantissa = std::frexp (increment * (float) tableSize, &exponent);
+
+    // frexp gives increment * tableSize = mantissa * 2^exponent with mantissa in
+    // [0.5, 1), so an exact power of two belongs to the level below
+    const auto level = mantissa == 0.5f ? exponent - 1 : exponent;
+    return getLevel (juce::jlimit (0, numLevels - 1, level));
+}
+
+//==============================================================================
+WavetableBank::WavetableBank() = default;
+
+float WavetableBank::getNaiveSample (int waveType, float phase)
+{
+    switch (waveType)
+    {
+        case sine:      return std::sin (phase * juce::MathConstants<float>::twoPi);
+        case saw:       return phase * 2.0f - 1.0f;
+        case square:    return phase < 0.5f ? 1.0f : -1.0f;
+        case triangle:  return std::abs (phase * 2.0f - 1.0f) * 2.0f - 1.0f;
+        default:        return 0.0f;
+    }
+}
+
+void WavetableBank::prepare (double newSampleRate)
+{
+    const juce::ScopedLock sl (userLock);
+
+    if (! juce::approximatelyEqual (sampleRate, newSampleRate) || builtIn[0] == nullptr)
+    {
+        sampleRate = newSampleRate;
+
+        // Keep a little headroom below Nyquist and nothing above the audible range
+        maxNormalisedFrequency = juce::jmin (0.45, 20000.0 / newSampleRate);
+
+        buildBuiltInTables();
+        publishUserTable (buildUserTable());
+    }
+
+    // Nothing renders while the host is preparing, so the audio thread can be
+    // moved straight onto the newest table and every other one dropped
+    userTable = publishedUserTable.load();
+    acquiringUserTable.store (userTable);
+    reachableUserTable.store (userTable);
+    publishUserTable (nullptr);
+}
+
+void WavetableBank::buildBuiltInTables()
+{
+    for (int waveType = 0; waveType < user; ++waveType)
+    {
+        builtIn[(size_t) waveType] = SharedTableCache::get<Wavetable> ("Wavetable " + juce::String (waveType), sampleRate, [&]
+        {
+            std::vector<float> cycle (Wavetable::tableSize);
+
+            for (int i = 0; i < Wavetable::tableSize; ++i)
+                cycle[(size_t) i] = getNaiveSample (waveType, (float) i / Wavetable::tableSize);
+
+            return std::make_unique<Wavetable> (cycle.data(), Wavetable::tableSize, maxNormalisedFrequency);
+        });
+    }
+}
+
+void WavetableBank::setUserWaveform (const float* cycle, int numSamples)
+{
+    const juce::ScopedLock sl (userLock);
+
+    if (cycle == nullptr || numSamples <= 0)
+        userCycle.clear();
+    else
+        userCycle.assign (cycle, cycle + numSamples);
+
+    if (sampleRate > 0.0)
+        publishUserTable (buildUserTable());
+}
+
+std::vector<float> WavetableBank::getUserWaveform() const
+{
+    const juce::ScopedLock sl (userLock);
+    return userCycle;
+}
+
+std::unique_ptr<Wavetable> WavetableBank::buildUserTable() const
+{
+    if (! userCycle.empty())
+        return std::make_unique<Wavetable> (userCycle.data(), (int) userCycle.size(), maxNormalisedFrequency);
+
+    // Until a user waveform is loaded the user slot plays a sine
+    std::vector<float> cycle (Wavetable::tableSize);
+
+    for (int i = 0; i < Wavetable::tableSize; ++i)
+        cycle[(size_t) i] = getNaiveSample (sine, (float) i / Wavetable::tableSize);
+
+    return std::make_unique<Wavetable> (cycle.data(), Wavetable::tableSize, maxNormalisedFrequency);
+}
+
+void WavetableBank::publishUserTable (std::unique_ptr<Wavetable> table)
+{
+    if (table != nullptr)
+    {
+        userTables.push_back (std::move (table));
+        publishedUserTable.store (userTables.back().get());
+    }
+
+    // Whatever the audio thread takes from here on is the published table, so
+    // only the two it has announced can still be in use. Read them in the
+    // opposite order to the one updateUserTable() writes them in
+    auto* acquiring = acquiringUserTable.load();
+    auto* reachable = reachableUserTable.load();
+    auto* published = publishedUserTable.load();
+
+    userTables.erase (std::remove_if (userTables.begin(), userTables.end(), [&] (const auto& t)
+                      {
+                          return t.get() != published && t.get() != acquiring && t.get() != reachable;
+                      }),
+                      userTables.end());
+}
+
+bool WavetableBank::updateUserTable() noexcept
+{
+    reachableUserTable.store (userTable);
+
+    auto* latest = publishedUserTable.load();
+
+    if (latest == userTable)
+        return false;
+
+    // If the message thread published again in between, it may already have
+    // freed this one; leave it to the next tick
+    acquiringUserTable.store (latest);
+
+    if (publishedUserTable.load() != latest)
+        return false;
+
+    userTable = latest;
+    return true;
+}
+
+const float* WavetableBank::getTable (int waveType, float increment) const
+{
+    if (waveType == user && userTable != nullptr)
+        return userTable->getTableForIncrement (increment);
+
+    const auto& table = builtIn[(size_t) juce::jlimit (0, user - 1, waveType)];
+    return table != nullptr ? table->getTableForIncrement (increment) : nullptr;
+}
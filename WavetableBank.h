@@ -0,0 +1,114 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "SharedTableCache.h"
+
+//==============================================================================
+/** One single-cycle waveform stored as a set of band-limited tables, one per
+    octave of playback frequency.
+
+    Level k is alias-free for normalised phase increments up to 2^k / tableSize.
+    Every table carries one guard sample so linear interpolation never wraps.
+*/
+class Wavetable
+{
+public:
+    static constexpr int tableOrder = 11;
+    static constexpr int tableSize = 1 << tableOrder;
+    static constexpr int numLevels = tableOrder;
+
+    /** Builds the mipmaps from one cycle of samples, which is resampled to
+        tableSize if needed. Harmonics above maxNormalisedFrequency (a fraction
+        of the sample rate) are removed at every level.
+    */
+    Wavetable (const float* cycle, int numSamples, double maxNormalisedFrequency);
+
+    /** Returns the table to use for a given phase increment per sample. */
+    const float* getTableForIncrement (float increment) const;
+
+    const float* getLevel (int level) const     { return tables.data() + (size_t) level * (tableSize + 1); }
+
+private:
+    std::vector<float> tables;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Wavetable)
+};
+
+//==============================================================================
+/** The band-limited tables for every OSC1_WAVE/OSC2_WAVE choice.
+
+    The built-in shapes are fetched in prepare() when the sample rate changes,
+    from the SharedTableCache, so all instances at one rate share them.
+
+    A user single-cycle waveform can be swapped in from the message thread at
+    any time. The audio thread picks it up in updateUserTable() and then
+    fetches its tables again, and says which tables it may still be reading
+    while it does, so every other one is freed with the next swap. At most
+    three user tables are ever alive.
+*/
+class WavetableBank
+{
+public:
+    enum WaveType
+    {
+        sine = 0,
+        saw,
+        square,
+        triangle,
+        user,
+        numWaveTypes
+    };
+
+    WavetableBank();
+
+    void prepare (double sampleRate);
+
+    /** Replaces the user waveform with one cycle of samples, or with the
+        default sine for 0 samples. Message thread.
+    */
+    void setUserWaveform (const float* cycle, int numSamples);
+
+    /** The cycle setUserWaveform() was given, empty for the default. Any
+        thread but the audio thread.
+    */
+    std::vector<float> getUserWaveform() const;
+
+    /** Audio thread, before rendering each tick. Returns true when a new user
+        waveform was picked up, in which case every table handed out so far
+        has to be fetched again before the next call.
+    */
+    bool updateUserTable() noexcept;
+
+    /** Audio thread. */
+    const float* getTable (int waveType, float increment) const;
+
+    static float getNaiveSample (int waveType, float phase);
+
+private:
+    void buildBuiltInTables();
+    std::unique_ptr<Wavetable> buildUserTable() const;
+    void publishUserTable (std::unique_ptr<Wavetable> table);
+
+    double sampleRate = 0.0;
+    double maxNormalisedFrequency = 0.5;
+
+    std::array<std::shared_ptr<const Wavetable>, user> builtIn;
+
+    // Message thread side, under userLock
+    juce::CriticalSection userLock;
+    std::vector<float> userCycle;
+    std::vector<std::unique_ptr<Wavetable>> userTables;
+
+    // The newest user table, and the ones the audio thread may be reading:
+    // the one it's switching to and the one it switched from
+    std::atomic<Wavetable*> publishedUserTable { nullptr };
+    std::atomic<Wavetable*> acquiringUserTable { nullptr };
+    std::atomic<Wavetable*> reachableUserTable { nullptr };
+
+    // Audio thread side
+    Wavetable* userTable = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavetableBank)
+};